@@ -8,7 +8,7 @@ pub fn build(b: *std.Build) !void {
 
     var cpp_entries = CppEntries.init(b, .{ .target = target, .optimize = optimize });
     defer cpp_entries.deinit();
-    const cpp_testing = cpp_entries.install_cpp_library("testing", &.{ "include/testing_lib/complexity.cc", "include/testing_lib/sort.cc", "include/testing_lib/framework.cc" });
+    const cpp_testing = cpp_entries.install_cpp_library("testing", &.{ "include/testing_lib/complexity.cc", "include/testing_lib/sort.cc", "include/testing_lib/framework.cc", "include/testing_lib/perf.cc", "include/testing_lib/adversary.cc", "include/testing_lib/export.cc" });
     const testing = cpp_entries.install_zig_library("zig_testing", .{
         .root_source_file = b.path("include/algo_test_lib/main.zig"),
         .target = target,
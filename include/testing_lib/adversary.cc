@@ -0,0 +1,67 @@
+#include "adversary.hpp"
+#include "framework.hpp"
+#include <algorithm>
+#include <memory>
+namespace testing_adversary {
+using testing_framework::Control;
+
+KillerAdversary::KillerAdversary(int size) : values(size, size), gas(size) {}
+
+int KillerAdversary::compare(int lhs, int rhs) {
+  if (values[lhs] == gas && values[rhs] == gas) {
+    if (lhs == candidate) {
+      values[lhs] = solid++;
+    } else {
+      values[rhs] = solid++;
+    }
+  }
+  if (values[lhs] == gas) {
+    candidate = lhs;
+  } else if (values[rhs] == gas) {
+    candidate = rhs;
+  }
+  return (values[lhs] > values[rhs]) - (values[lhs] < values[rhs]);
+}
+
+std::vector<int> KillerAdversary::input() {
+  for (int &value : values) {
+    if (value == gas) {
+      value = solid++;
+    }
+  }
+  return values;
+}
+
+AdversaryResult find_worst_case(const SortingFunction &funcptr, int size) {
+  AdversaryResult result;
+  result.size = size;
+  if (size <= 0) {
+    result.replay_sorted = true;
+    return result;
+  }
+  Control &control = Control::get_instance();
+  std::unique_ptr<Testing[]> arr(new Testing[size]);
+  for (int i = 0; i < size; i++) {
+    arr[i].value = i;
+  }
+
+  KillerAdversary adversary(size);
+  control.reset_and_get_thread_snapshot();
+  control.set_comparison_hook(&adversary);
+  funcptr(arr.get(), size);
+  control.set_comparison_hook(nullptr);
+  result.adversary_comparisons =
+      control.reset_and_get_thread_snapshot().total_comparisons();
+  result.input = adversary.input();
+
+  for (int i = 0; i < size; i++) {
+    arr[i].value = result.input[i];
+  }
+  control.reset_and_get_thread_snapshot();
+  funcptr(arr.get(), size);
+  result.replay_comparisons =
+      control.reset_and_get_thread_snapshot().total_comparisons();
+  result.replay_sorted = std::is_sorted(arr.get(), arr.get() + size);
+  return result;
+}
+} // namespace testing_adversary
@@ -0,0 +1,50 @@
+#ifndef CINDY_TESTING_FRAMEWORK_ADVERSARY_H
+#define CINDY_TESTING_FRAMEWORK_ADVERSARY_H
+#include "framework.hpp"
+#include "prelude.hpp"
+#include <vector>
+namespace testing_adversary {
+using testing_framework::ComparisonHook;
+using testing_framework::Testing;
+PRELUDE;
+
+// McIlroy's "A Killer Adversary for Quicksort" (1999). The sort is handed
+// the elements 0..n-1, all of them "gas": not yet given a value and larger
+// than every value handed out so far. When two gas elements are compared one
+// is frozen to the next smallest value, preferring to freeze the one that is
+// not the likely pivot, so the pivot stays gas and ends up at an extreme of
+// every partition. Any comparison sort can be run against it; recording the
+// values handed out gives an input that makes that sort do the same work
+// without the adversary.
+class KillerAdversary : public ComparisonHook {
+public:
+  explicit KillerAdversary(int size);
+
+  int compare(int lhs, int rhs) override;
+
+  // Freezes whatever is still gas and returns the constructed input:
+  // element i of the result is the value the adversary gave element i.
+  std::vector<int> input();
+
+private:
+  std::vector<int> values;
+  int gas;
+  int solid = 0;
+  int candidate = -1;
+};
+
+struct AdversaryResult {
+  int size = 0;
+  unsigned long long adversary_comparisons = 0; // While constructing
+  unsigned long long replay_comparisons = 0;    // Sorting the input again
+  bool replay_sorted = false;
+  std::vector<int> input;
+};
+
+// Builds the adversarial input for funcptr at size and replays it. Counts
+// come from the calling thread's Control shard, so a sort that compares on
+// other threads is neither steered nor fully counted.
+AdversaryResult find_worst_case(const SortingFunction &funcptr, int size);
+} // namespace testing_adversary
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef CINDY_TESTING_FRAMEWORK_BENCHMARK_H
+#define CINDY_TESTING_FRAMEWORK_BENCHMARK_H
+#include "utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+namespace testing_benchmark {
+using Clock = std::chrono::steady_clock;
+
+// Written to by benchmarks so the optimizer cannot drop the measured work.
+// Thread local so multithreaded benchmarks do not race or share its line.
+inline thread_local volatile unsigned long long benchmark_sink = 0;
+
+template <typename T> inline void keep(const T &value) {
+  benchmark_sink = benchmark_sink + static_cast<unsigned long long>(value);
+}
+
+inline double elapsed_ns(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Runs body `repetitions` times and returns the fastest run in nanoseconds.
+template <typename Body> double best_of_ns(int repetitions, Body &&body) {
+  double best = 0;
+  for (int r = 0; r < repetitions; r++) {
+    Clock::time_point start = Clock::now();
+    body();
+    double ns = elapsed_ns(start, Clock::now());
+    best = (r == 0) ? ns : std::min(best, ns);
+  }
+  return best;
+}
+
+// Nearest rank percentile, p in [0, 100]. Sorts the samples in place.
+inline double percentile(std::vector<double> &samples, double p) {
+  if (samples.empty()) {
+    return 0;
+  }
+  std::sort(samples.begin(), samples.end());
+  size_t rank = static_cast<size_t>(p / 100.0 * (samples.size() - 1) + 0.5);
+  return samples[std::min(rank, samples.size() - 1)];
+}
+
+inline void print_benchmark_header(const std::string &title) {
+  testing_utils::print_colored_line("--- Benchmark: " + title + " ---",
+                                    testing_utils::BOLD_CYAN);
+  std::cout << std::left << std::setw(40) << "Variant" << std::setw(16)
+            << "Time (ms)" << std::setw(14) << "ns/op" << std::setw(14)
+            << "Mops/s" << std::endl;
+  std::cout << std::string(84, '-') << std::endl;
+}
+
+inline void print_benchmark_row(const std::string &variant, double ns,
+                                long long operations) {
+  double ns_per_op = operations > 0 ? ns / operations : 0;
+  double mops = ns > 0 ? operations * 1e3 / ns : 0;
+  std::cout << std::left << std::fixed << std::setprecision(3)
+            << std::setw(40) << variant << std::setw(16) << ns / 1e6
+            << std::setw(14) << ns_per_op << std::setw(14) << mops
+            << std::defaultfloat << std::endl;
+}
+// Latency benchmarks print percentiles of their samples instead of a total
+// time, so they get a table of their own.
+inline void print_latency_header(const std::string &title) {
+  testing_utils::print_colored_line("--- Benchmark: " + title + " ---",
+                                    testing_utils::BOLD_CYAN);
+  std::cout << std::left << std::setw(40) << "Variant" << std::setw(10)
+            << "Samples" << std::setw(12) << "p50 (ns)" << std::setw(12)
+            << "p90 (ns)" << std::setw(12) << "p99 (ns)" << std::endl;
+  std::cout << std::string(86, '-') << std::endl;
+}
+
+inline void print_latency_row(const std::string &variant,
+                              std::vector<double> &samples) {
+  std::cout << std::left << std::fixed << std::setprecision(0)
+            << std::setw(40) << variant << std::setw(10) << samples.size()
+            << std::setw(12) << percentile(samples, 50) << std::setw(12)
+            << percentile(samples, 90) << std::setw(12)
+            << percentile(samples, 99) << std::defaultfloat << std::endl;
+}
+} // namespace testing_benchmark
+#endif
@@ -4,7 +4,9 @@
 #include "utils.hpp"
 #include <algorithm>
 #include <cmath>
+#include <iomanip>
 #include <limits>
+#include <sstream>
 #include <string>
 namespace testing_complexity {
 using testing_framework::Complexity;
@@ -31,6 +33,228 @@ std::string complexity_to_string(Complexity c) {
     return "Unknown";
   }
 }
+std::string growth_model_to_string(GrowthModel m) {
+  switch (m) {
+  case GrowthModel::Constant:
+    return "1";
+  case GrowthModel::Log:
+    return "log n";
+  case GrowthModel::Linear:
+    return "n";
+  case GrowthModel::NLogN:
+    return "n log n";
+  case GrowthModel::N1_5:
+    return "n^1.5";
+  case GrowthModel::N2:
+    return "n^2";
+  case GrowthModel::PowerLaw:
+    return "n^k";
+  default:
+    return "Unknown";
+  }
+}
+
+double ComplexityFit::relative_error() const {
+  if (points == 0) {
+    return 0;
+  }
+  return std::exp(std::sqrt(residual / points)) - 1;
+}
+
+Complexity ComplexityFit::complexity() const {
+  if (points < 2) {
+    return Complexity::InsufficientData;
+  }
+  // Same tolerance the pairwise estimate used.
+  if (relative_error() > 0.35) {
+    return Complexity::Undetermined;
+  }
+  switch (model) {
+  case GrowthModel::Constant:
+    return Complexity::O1;
+  case GrowthModel::Linear:
+    return Complexity::ON;
+  case GrowthModel::NLogN:
+    return Complexity::ONLogN;
+  case GrowthModel::N2:
+    return Complexity::ON2;
+  default:
+    return Complexity::Undetermined;
+  }
+}
+
+std::string ComplexityFit::to_string() const {
+  std::ostringstream text;
+  text << std::setprecision(3) << constant;
+  if (model == GrowthModel::PowerLaw) {
+    text << " n^" << std::fixed << std::setprecision(2) << exponent;
+  } else if (model != GrowthModel::Constant) {
+    text << " " << growth_model_to_string(model);
+  }
+  text << std::fixed << std::setprecision(4) << " (R^2 " << r_squared << ")";
+  return text.str();
+}
+
+std::vector<ComplexityFit>
+fit_all_models(const std::vector<std::pair<double, double>> &points) {
+  std::vector<double> log_n;
+  std::vector<double> log_cost;
+  int zero_points = 0;
+  for (const auto &p : points) {
+    if (p.first > 1 && p.second > 0) {
+      log_n.push_back(std::log(p.first));
+      log_cost.push_back(std::log(p.second));
+    } else if (p.first > 1) {
+      zero_points++;
+    }
+  }
+  const int m = int(log_n.size());
+  std::vector<ComplexityFit> fits;
+  if (m == 0) {
+    // No cost at any size: constant (zero), exactly.
+    ComplexityFit fit;
+    fit.points = zero_points;
+    fit.r_squared = 1;
+    fits.push_back(fit);
+    return fits;
+  }
+
+  double mean = 0;
+  for (double y : log_cost) {
+    mean += y / m;
+  }
+  double total = 0;
+  for (double y : log_cost) {
+    total += (y - mean) * (y - mean);
+  }
+  auto r_squared = [&](double residual) {
+    if (total > 1e-12) {
+      return 1 - residual / total;
+    }
+    return residual < 1e-12 ? 1.0 : 0.0;
+  };
+
+  // Fixed models: cost ~ c f(n) + d g(n), g the next lower order term
+  // (n below n log n and up, 1 below n and log n), which small sizes would
+  // otherwise blame on the leading term. c and d minimise the squared
+  // relative error; with fewer than three points d is left out, as two
+  // terms would fit any two points exactly.
+  const GrowthModel fixed[] = {GrowthModel::Constant, GrowthModel::Log,
+                               GrowthModel::Linear,   GrowthModel::NLogN,
+                               GrowthModel::N1_5,     GrowthModel::N2};
+  for (GrowthModel model : fixed) {
+    std::vector<double> f(m);
+    std::vector<double> g(m);
+    for (int i = 0; i < m; i++) {
+      double n = std::exp(log_n[i]);
+      double log2_n = log_n[i] / std::log(2.0);
+      switch (model) {
+      case GrowthModel::Constant:
+        f[i] = 1;
+        g[i] = 0;
+        break;
+      case GrowthModel::Log:
+        f[i] = log2_n;
+        g[i] = 1;
+        break;
+      case GrowthModel::Linear:
+        f[i] = n;
+        g[i] = 1;
+        break;
+      case GrowthModel::NLogN:
+        f[i] = n * log2_n;
+        g[i] = n;
+        break;
+      case GrowthModel::N1_5:
+        f[i] = n * std::sqrt(n);
+        g[i] = n;
+        break;
+      default:
+        f[i] = n * n;
+        g[i] = n;
+        break;
+      }
+    }
+    // Normal equations of sum ((cost - c f - d g) / cost)^2.
+    double ff = 0, fg = 0, gg = 0, f1 = 0, g1 = 0;
+    for (int i = 0; i < m; i++) {
+      double cost = std::exp(log_cost[i]);
+      double a = f[i] / cost;
+      double b = g[i] / cost;
+      ff += a * a;
+      fg += a * b;
+      gg += b * b;
+      f1 += a;
+      g1 += b;
+    }
+    double c = f1 / ff;
+    double d = 0;
+    double det = ff * gg - fg * fg;
+    if (m >= 3 && model != GrowthModel::Constant && det > 1e-12 * ff * gg) {
+      c = (f1 * gg - g1 * fg) / det;
+      d = (g1 * ff - f1 * fg) / det;
+    }
+
+    ComplexityFit fit;
+    fit.model = model;
+    fit.points = m;
+    fit.constant = c;
+    for (int i = 0; i < m; i++) {
+      double predicted = c * f[i] + d * g[i];
+      // A fit that predicts no cost somewhere, or needs a negative leading
+      // term, does not describe the data.
+      double error = c > 0 && predicted > 0
+                         ? log_cost[i] - std::log(predicted)
+                         : std::numeric_limits<double>::infinity();
+      fit.residual += error * error;
+    }
+    fit.r_squared = r_squared(fit.residual);
+    fits.push_back(fit);
+  }
+
+  // Power law: ordinary regression of log cost on log n.
+  ComplexityFit power;
+  power.model = GrowthModel::PowerLaw;
+  power.points = m;
+  double mean_x = 0;
+  for (double x : log_n) {
+    mean_x += x / m;
+  }
+  double sxx = 0;
+  double sxy = 0;
+  for (int i = 0; i < m; i++) {
+    sxx += (log_n[i] - mean_x) * (log_n[i] - mean_x);
+    sxy += (log_n[i] - mean_x) * (log_cost[i] - mean);
+  }
+  power.exponent = sxx > 0 ? sxy / sxx : 0;
+  double log_c = mean - power.exponent * mean_x;
+  power.constant = std::exp(log_c);
+  for (int i = 0; i < m; i++) {
+    double error = log_cost[i] - log_c - power.exponent * log_n[i];
+    power.residual += error * error;
+  }
+  power.r_squared = r_squared(power.residual);
+  fits.push_back(power);
+  return fits;
+}
+
+ComplexityFit
+fit_complexity(const std::vector<std::pair<double, double>> &points) {
+  std::vector<ComplexityFit> fits = fit_all_models(points);
+  ComplexityFit best = fits.front();
+  for (const ComplexityFit &fit : fits) {
+    if (fit.model != GrowthModel::PowerLaw && fit.residual < best.residual) {
+      best = fit;
+    }
+  }
+  const ComplexityFit &power = fits.back();
+  if (fits.size() > 1 && power.points >= 3 &&
+      power.residual * 4 < best.residual) {
+    best = power;
+  }
+  return best;
+}
+
 Complexity estimate_complexity_from_pair(double n1, double ops1, double n2,
                                          double ops2) {
   if (n1 <= 0 || n2 <= 0 || ops1 < 0 || ops2 < 0 ||
@@ -119,54 +343,69 @@ Complexity estimate_complexity_from_pair(double n1, double ops1, double n2,
 Complexity estimate_complexity_for_type(
     const std::vector<std::pair<int, ControlStatsSnapshot>> &data,
     bool use_comparisons) {
-  std::vector<std::pair<double, double>> valid_points;
+  std::vector<std::pair<double, double>> points;
   for (const auto &p : data) {
-    if (p.first > 1) { // Use size > 1 for log/ratio stability
-      double ops = use_comparisons
-                       ? static_cast<double>(p.second.total_comparisons())
-                       : static_cast<double>(p.second.total_data_moves());
-      // We need points for ratio, even if ops is 0 for O(1) check in pair
-      // estimator
-      valid_points.push_back({static_cast<double>(p.first), ops});
-    }
+    double ops = use_comparisons
+                     ? static_cast<double>(p.second.total_comparisons())
+                     : static_cast<double>(p.second.total_data_moves());
+    points.push_back({static_cast<double>(p.first), ops});
   }
+  return fit_complexity(points).complexity();
+}
 
-  // Sort by size just in case (should already be sorted)
-  std::sort(valid_points.begin(), valid_points.end());
-
-  if (valid_points.size() < 2) {
-    // Check for O(1) possibility even with few points
-    bool all_zero_ops = true;
-    bool const_ops = true;
-    double first_ops = -1;
-
-    for (const auto &p : valid_points) {
-      if (p.second != 0)
-        all_zero_ops = false;
-      if (first_ops < 0)
-        first_ops = p.second;
-      if (p.second != first_ops)
-        const_ops = false;
-    }
-    if (!valid_points.empty() &&
-        (all_zero_ops || (const_ops && first_ops >= 0))) {
-      return Complexity::O1;
+namespace {
+// (size, cost) of every result of one input type: the operation count, or
+// the median time when timed is set and the case was timed.
+std::vector<std::pair<double, double>>
+cost_points(const std::vector<std::pair<int, SortingResult>> &type_results,
+            bool use_comparisons, bool timed) {
+  std::vector<std::pair<double, double>> points;
+  for (const auto &p : type_results) {
+    const SortingResult &res = p.second;
+    if (timed) {
+      if (res.timing.repetitions > 0) {
+        points.push_back({double(p.first), res.timing.median_ns});
+      }
+    } else {
+      points.push_back({double(p.first),
+                        double(use_comparisons
+                                   ? res.snapshot.total_comparisons()
+                                   : res.snapshot.total_data_moves())});
     }
-
-    return Complexity::InsufficientData;
   }
+  return points;
+}
 
-  // Use the two largest sizes for the estimation for asymptotic behavior
-  const auto &p1 = valid_points[valid_points.size() - 2];
-  const auto &p2 = valid_points[valid_points.size() - 1];
-
-  return estimate_complexity_from_pair(p1.first, p1.second, p2.first,
-                                       p2.second);
+void print_fit(const std::string &label, const std::string &metric,
+               const std::vector<std::pair<double, double>> &points,
+               bool verbose) {
+  std::vector<ComplexityFit> fits = fit_all_models(points);
+  ComplexityFit best = fit_complexity(points);
+  std::cout << "  " << label << metric << " ~ ";
+  if (best.points < 2) {
+    std::cout << "insufficient data" << std::endl;
+    return;
+  }
+  std::cout << best.to_string();
+  if (best.model != GrowthModel::PowerLaw && fits.size() > 1) {
+    std::cout << ", power law n^" << std::fixed << std::setprecision(2)
+              << fits.back().exponent << std::defaultfloat;
+  }
+  std::cout << std::endl;
+  if (verbose) {
+    for (const ComplexityFit &fit : fits) {
+      std::cout << "      " << std::left << std::setw(10)
+                << growth_model_to_string(fit.model) << fit.to_string()
+                << std::endl;
+    }
+  }
 }
+} // namespace
+
 bool analyze_and_print_complexity(
     const ResultsMap &results,
-    const testing_framework::TestOptions &options) // Pass full options struct
-{
+    const testing_framework::TestOptions &options, // Pass full options struct
+    ComplexityEstimate *estimate) {
   bool complexity_mismatch_occurred = false;
   const auto &sizes = options.sizes; // Get sizes from options
 
@@ -246,6 +485,13 @@ bool analyze_and_print_complexity(
         stats, options.estimate_based_on_comparisons);
   }
 
+  if (estimate) {
+    estimate->best_case_type = best_case_type;
+    estimate->worst_case_type = worst_case_type;
+    estimate->best_case = best_case_est;
+    estimate->worst_case = worst_case_est;
+  }
+
   // --- Compare with Expectations & Prepare Status Strings ---
   std::string best_status_str;
   if (options.expected_best_complexity.has_value()) {
@@ -295,8 +541,39 @@ bool analyze_and_print_complexity(
                          ? testing_utils::BOLD_RED
                          : testing_utils::RESET); // Color if mismatch
 
-  print_colored_line("Note: Complexity estimation is empirical and based on "
-                     "observed ratios for tested sizes.",
+  // --- Least-Squares Fits ---
+  int fitted_sizes = 0;
+  int smallest_size = largest_size;
+  for (int s : sizes) {
+    if (s > 1) {
+      fitted_sizes++;
+      smallest_size = std::min(smallest_size, s);
+    }
+  }
+  std::cout << "Least-squares fit over " << fitted_sizes << " sizes (N = "
+            << smallest_size << ".." << largest_size << "), cost ~ c * f(N):"
+            << std::endl;
+  for (const auto &type : {std::make_pair("Best  ", best_case_type),
+                           std::make_pair("Worst ", worst_case_type)}) {
+    if (!results.count(type.second)) {
+      continue;
+    }
+    const auto &type_results = results.at(type.second);
+    std::string label = type.first + std::string("(") + type.second + "): ";
+    print_fit(label, complexity_metric_name,
+              cost_points(type_results, options.estimate_based_on_comparisons,
+                          false),
+              options.verbose);
+    std::vector<std::pair<double, double>> times =
+        cost_points(type_results, options.estimate_based_on_comparisons, true);
+    if (!times.empty()) {
+      print_fit(std::string(label.size(), ' '), "Time (ns)", times,
+                options.verbose);
+    }
+  }
+
+  print_colored_line("Note: Complexity estimation is empirical, a "
+                     "least-squares fit over all tested sizes.",
                      testing_utils::YELLOW);
 
   return complexity_mismatch_occurred;
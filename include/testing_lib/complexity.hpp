@@ -4,6 +4,7 @@
 #include "prelude.hpp"
 #include "utils.hpp"
 #include <string>
+#include <vector>
 namespace testing_complexity {
 using testing_framework::Complexity;
 using testing_framework::Control;
@@ -15,14 +16,58 @@ using testing_utils::print_colored_line;
 PRELUDE;
 std::string complexity_to_string(Complexity c);
 
+// Growth models fitted by fit_complexity, cost ~ constant * f(n).
+enum class GrowthModel { Constant, Log, Linear, NLogN, N1_5, N2, PowerLaw };
+std::string growth_model_to_string(GrowthModel m);
+
+struct ComplexityFit {
+  GrowthModel model = GrowthModel::Constant;
+  double constant = 0; // Fitted factor c
+  double exponent = 0; // k of n^k, for PowerLaw
+  double r_squared = 0;
+  double residual = 0; // Sum of squared log errors
+  int points = 0;      // Sizes with a nonzero cost that were fitted
+
+  double relative_error() const; // Typical relative deviation from the fit
+  Complexity complexity() const; // Undetermined if not a Complexity or poor
+  std::string to_string() const; // E.g. "1.02 n log n (R^2 0.9991)", or
+                                 // "12 (R^2 1.0000)" for a constant
+};
+
+// Least-squares fit of cost against every model over all (n, cost) points
+// with n > 1, in log space so that each size weighs the same however large
+// its cost; with sizes up to 10^8 a plain fit would see only the largest.
+// Returns one fit per model, in GrowthModel order, with r_squared relative
+// to the mean log cost. Zero costs cannot be logged and are left out; if
+// every cost is zero the result is a single exact Constant fit.
+std::vector<ComplexityFit>
+fit_all_models(const std::vector<std::pair<double, double>> &points);
+
+// The best of fit_all_models: the fixed model with the least residual, or
+// the power law when there are three or more points and it fits at least
+// four times better than every fixed model.
+ComplexityFit
+fit_complexity(const std::vector<std::pair<double, double>> &points);
+
 Complexity estimate_complexity_from_pair(double n1, double ops1, double n2,
                                          double ops2);
 Complexity estimate_complexity_for_type(
     const std::vector<std::pair<int, ControlStatsSnapshot>> &data,
     bool use_comparisons = true);
 
-bool analyze_and_print_complexity(
-    const ResultsMap &results, const testing_framework::TestOptions &options);
+// What analyze_and_print_complexity concluded for one algorithm.
+struct ComplexityEstimate {
+  std::string best_case_type = "N/A";  // Cheapest input type at the largest N
+  std::string worst_case_type = "N/A"; // Most expensive one
+  Complexity best_case = Complexity::InsufficientData;
+  Complexity worst_case = Complexity::InsufficientData;
+};
+
+// Prints the estimate and returns whether it contradicts an expectation in
+// options; estimate, if given, receives it.
+bool analyze_and_print_complexity(const ResultsMap &results,
+                                  const testing_framework::TestOptions &options,
+                                  ComplexityEstimate *estimate = nullptr);
 } // namespace testing_complexity
 
 #endif
@@ -0,0 +1,124 @@
+#ifndef CINDY_TESTING_FRAMEWORK_COUNTED_H
+#define CINDY_TESTING_FRAMEWORK_COUNTED_H
+#include "framework.hpp"
+#include <cstddef>
+#include <ostream>
+#include <utility>
+namespace testing_framework {
+// Counting policies for Counted. A policy owns the counters for every
+// Counted type instantiated with it and increments them inline, so the
+// element itself carries no pointer and the sort being measured is compiled
+// the same way it would be for a plain struct.
+//   ControlStatsSnapshot &counts()        counters of the calling thread
+//   ControlStatsSnapshot reset_and_get_snapshot()
+
+// One set of counters for the whole program. Cheapest; single threaded only.
+struct StaticCounterPolicy {
+  static ControlStatsSnapshot &counts() {
+    static ControlStatsSnapshot instance;
+    return instance;
+  }
+  static ControlStatsSnapshot reset_and_get_snapshot() {
+    ControlStatsSnapshot snapshot = counts();
+    counts() = ControlStatsSnapshot();
+    return snapshot;
+  }
+};
+
+// One set of counters per thread, which can count parallel work without
+// races; a snapshot only sees the calling thread.
+struct ThreadLocalCounterPolicy {
+  static ControlStatsSnapshot &counts() {
+    static thread_local ControlStatsSnapshot instance;
+    return instance;
+  }
+  static ControlStatsSnapshot reset_and_get_snapshot() {
+    ControlStatsSnapshot snapshot = counts();
+    counts() = ControlStatsSnapshot();
+    return snapshot;
+  }
+};
+
+// Fixed size record for Payload: an int key padded with Bytes - 4 bytes of
+// data that is copied along with it, like the rest of a row would be.
+template <size_t Bytes> struct Record {
+  static_assert(Bytes >= sizeof(int) && Bytes <= 256,
+                "Record payloads are 4 to 256 bytes");
+  int key;
+  unsigned char data[Bytes - sizeof(int)];
+
+  Record() : key(0), data() {}
+  Record(int key) : key(key), data() {}
+  int get_value() const { return key; }
+};
+
+template <> struct Record<sizeof(int)> {
+  int key;
+
+  Record() : key(0) {}
+  Record(int key) : key(key) {}
+  int get_value() const { return key; }
+};
+
+// Instrumented element like Testing, counting comparisons, copies and moves
+// through CounterPolicy instead of a per object Control pointer. Payload is
+// compared via get_value() and is otherwise just copied around; with
+// Record<Bytes> sizeof(Counted) == Bytes.
+template <typename Payload, typename CounterPolicy = ThreadLocalCounterPolicy>
+class Counted {
+public:
+  Payload payload;
+
+  Counted() = default;
+  Counted(int value) : payload(value) {}
+
+  Counted(const Counted &other) : payload(other.payload) {
+    CounterPolicy::counts().copy_constructor_count++;
+  }
+  Counted(Counted &&other) noexcept : payload(std::move(other.payload)) {
+    CounterPolicy::counts().move_constructor_count++;
+  }
+  Counted &operator=(const Counted &other) {
+    payload = other.payload;
+    CounterPolicy::counts().copy_assignment_count++;
+    return *this;
+  }
+  Counted &operator=(Counted &&other) noexcept {
+    payload = std::move(other.payload);
+    CounterPolicy::counts().move_assignment_count++;
+    return *this;
+  }
+
+  int get_value() const { return payload.get_value(); }
+
+  friend bool operator<(const Counted &lhs, const Counted &rhs) {
+    CounterPolicy::counts().less_than_count++;
+    return lhs.get_value() < rhs.get_value();
+  }
+  friend bool operator>(const Counted &lhs, const Counted &rhs) {
+    CounterPolicy::counts().greater_than_count++;
+    return lhs.get_value() > rhs.get_value();
+  }
+  friend bool operator<=(const Counted &lhs, const Counted &rhs) {
+    CounterPolicy::counts().less_equal_count++;
+    return lhs.get_value() <= rhs.get_value();
+  }
+  friend bool operator>=(const Counted &lhs, const Counted &rhs) {
+    CounterPolicy::counts().greater_equal_count++;
+    return lhs.get_value() >= rhs.get_value();
+  }
+  friend bool operator==(const Counted &lhs, const Counted &rhs) {
+    CounterPolicy::counts().equal_count++;
+    return lhs.get_value() == rhs.get_value();
+  }
+  friend bool operator!=(const Counted &lhs, const Counted &rhs) {
+    CounterPolicy::counts().not_equal_count++;
+    return lhs.get_value() != rhs.get_value();
+  }
+  friend std::ostream &operator<<(std::ostream &os, const Counted &obj) {
+    return os << obj.get_value();
+  }
+};
+} // namespace testing_framework
+
+#endif
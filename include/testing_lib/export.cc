@@ -0,0 +1,366 @@
+#include "export.hpp"
+#include "complexity.hpp"
+#include "framework.hpp"
+#include "functions.hpp"
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/utsname.h>
+#endif
+
+namespace testing_export {
+using testing_complexity::ComplexityFit;
+using testing_framework::ControlStatsSnapshot;
+using testing_framework::SortingResult;
+namespace {
+// One column of a record. Text is quoted in both formats, Number is
+// written as is, Null becomes null in JSON and an empty CSV field.
+struct Field {
+  enum Kind { Number, Text, Null };
+  std::string name;
+  std::string value;
+  Kind kind;
+};
+using Record = std::vector<Field>;
+
+void add_text(Record &record, const std::string &name,
+              const std::string &value) {
+  record.push_back({name, value, Field::Text});
+}
+
+void add_number(Record &record, const std::string &name,
+                unsigned long long value) {
+  record.push_back({name, std::to_string(value), Field::Number});
+}
+
+void add_number(Record &record, const std::string &name, double value) {
+  if (!std::isfinite(value)) {
+    record.push_back({name, "", Field::Null});
+    return;
+  }
+  std::ostringstream text;
+  text.precision(10);
+  text << value;
+  record.push_back({name, text.str(), Field::Number});
+}
+
+void add_bool(Record &record, const std::string &name, bool value) {
+  record.push_back({name, value ? "true" : "false", Field::Number});
+}
+
+void add_null(Record &record, const std::string &name) {
+  record.push_back({name, "", Field::Null});
+}
+
+void add_optional(Record &record, const std::string &name,
+                  const std::optional<unsigned long long> &value) {
+  if (value) {
+    add_number(record, name, *value);
+  } else {
+    add_null(record, name);
+  }
+}
+
+std::string json_escape(const std::string &text) {
+  std::string escaped;
+  for (char c : text) {
+    switch (c) {
+    case '"':
+      escaped += "\\\"";
+      break;
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    case '\t':
+      escaped += "\\t";
+      break;
+    default:
+      if ((unsigned char)c < 0x20) {
+        char code[8];
+        std::snprintf(code, sizeof(code), "\\u%04x", (unsigned char)c);
+        escaped += code;
+      } else {
+        escaped += c;
+      }
+    }
+  }
+  return escaped;
+}
+
+std::string csv_escape(const std::string &text) {
+  if (text.find_first_of(",\"\n\r") == std::string::npos) {
+    return text;
+  }
+  std::string escaped = "\"";
+  for (char c : text) {
+    escaped += c;
+    if (c == '"') {
+      escaped += '"';
+    }
+  }
+  return escaped + "\"";
+}
+
+void write_json(std::ostream &out, const Record &record) {
+  out << "{";
+  for (size_t i = 0; i < record.size(); i++) {
+    const Field &field = record[i];
+    out << (i ? "," : "") << "\"" << field.name << "\":";
+    switch (field.kind) {
+    case Field::Text:
+      out << "\"" << json_escape(field.value) << "\"";
+      break;
+    case Field::Number:
+      out << field.value;
+      break;
+    case Field::Null:
+      out << "null";
+      break;
+    }
+  }
+  out << "}\n";
+}
+
+void write_csv(std::ostream &out, const Record &record, bool header) {
+  if (header) {
+    for (size_t i = 0; i < record.size(); i++) {
+      out << (i ? "," : "") << record[i].name;
+    }
+    out << "\n";
+  }
+  for (size_t i = 0; i < record.size(); i++) {
+    out << (i ? "," : "");
+    if (record[i].kind == Field::Text) {
+      out << csv_escape(record[i].value);
+    } else if (record[i].kind == Field::Number) {
+      out << record[i].value;
+    }
+  }
+  out << "\n";
+}
+
+// Files the run has written to, so the first write truncates and later
+// ones (other algorithms) append.
+struct OpenFile {
+  std::ofstream out;
+  bool written = false;
+};
+std::mutex files_lock;
+std::map<std::string, std::unique_ptr<OpenFile>> files;
+
+OpenFile *open_file(const std::string &path) {
+  auto it = files.find(path);
+  if (it != files.end()) {
+    return it->second.get();
+  }
+  std::unique_ptr<OpenFile> file(new OpenFile);
+  file->out.open(path, std::ios::out | std::ios::trunc);
+  if (!file->out) {
+    std::cerr << "Warning: cannot write results to " << path << std::endl;
+    files[path] = nullptr;
+    return nullptr;
+  }
+  return (files[path] = std::move(file)).get();
+}
+
+std::string read_cpu_model() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      size_t colon = line.find(':');
+      if (colon != std::string::npos && colon + 2 <= line.size()) {
+        return line.substr(colon + 2);
+      }
+    }
+  }
+  return "unknown";
+}
+
+RunMetadata gather_metadata() {
+  RunMetadata metadata;
+#if defined(__clang__)
+  metadata.compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+  metadata.compiler = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+  metadata.compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+  metadata.compiler = "unknown";
+#endif
+#ifdef __OPTIMIZE__
+  metadata.build = "optimized";
+#else
+  metadata.build = "unoptimized";
+#endif
+#ifdef NDEBUG
+  metadata.build += ", NDEBUG";
+#endif
+  metadata.cxx_standard = std::to_string(__cplusplus);
+  metadata.cpu_model = read_cpu_model();
+  metadata.hardware_threads = std::thread::hardware_concurrency();
+#if defined(__unix__) || defined(__APPLE__)
+  utsname name;
+  if (uname(&name) == 0) {
+    metadata.os = std::string(name.sysname) + " " + name.release + " " +
+                  name.machine;
+  }
+#elif defined(_WIN32)
+  metadata.os = "Windows";
+#endif
+  if (metadata.os.empty()) {
+    metadata.os = "unknown";
+  }
+  std::time_t now = std::time(nullptr);
+  char started[32];
+  std::strftime(started, sizeof(started), "%Y-%m-%dT%H:%M:%SZ",
+                std::gmtime(&now));
+  metadata.started = started;
+  return metadata;
+}
+} // namespace
+
+const RunMetadata &run_metadata() {
+  static const RunMetadata metadata = gather_metadata();
+  return metadata;
+}
+
+void export_results(const std::string &algorithm, const ResultsMap &results,
+                    const TestOptions &options,
+                    const ComplexityEstimate &estimate) {
+  if (options.json_path.empty() && options.csv_path.empty()) {
+    return;
+  }
+  const RunMetadata &metadata = run_metadata();
+  std::vector<Record> records;
+  for (const auto &type_pair : results) {
+    std::vector<std::pair<double, double>> points;
+    for (const auto &res_pair : type_pair.second) {
+      const ControlStatsSnapshot &snapshot = res_pair.second.snapshot;
+      points.push_back({double(res_pair.first),
+                        double(options.estimate_based_on_comparisons
+                                   ? snapshot.total_comparisons()
+                                   : snapshot.total_data_moves())});
+    }
+    ComplexityFit fit = testing_complexity::fit_complexity(points);
+
+    for (const auto &res_pair : type_pair.second) {
+      int size = res_pair.first;
+      const SortingResult &result = res_pair.second;
+      const ControlStatsSnapshot &snapshot = result.snapshot;
+      Record record;
+      add_text(record, "algorithm", algorithm);
+      add_text(record, "generator", type_pair.first);
+      add_number(record, "size", (unsigned long long)size);
+      add_number(record, "seed", options.seed);
+      add_number(record, "case_seed",
+                 testing_functions::case_seed(options.seed, type_pair.first,
+                                              size));
+      add_bool(record, "sorted", result.sorted);
+
+      add_number(record, "less_than", snapshot.less_than_count);
+      add_number(record, "greater_than", snapshot.greater_than_count);
+      add_number(record, "less_equal", snapshot.less_equal_count);
+      add_number(record, "greater_equal", snapshot.greater_equal_count);
+      add_number(record, "equal", snapshot.equal_count);
+      add_number(record, "not_equal", snapshot.not_equal_count);
+      add_number(record, "copy_constructor", snapshot.copy_constructor_count);
+      add_number(record, "copy_assignment", snapshot.copy_assignment_count);
+      add_number(record, "move_constructor", snapshot.move_constructor_count);
+      add_number(record, "move_assignment", snapshot.move_assignment_count);
+      add_number(record, "comparisons", snapshot.total_comparisons());
+      add_number(record, "data_moves", snapshot.total_data_moves());
+
+      const auto &timing = result.timing;
+      if (timing.repetitions > 0) {
+        add_number(record, "timing_repetitions",
+                   (unsigned long long)timing.repetitions);
+        add_number(record, "min_ns", timing.min_ns);
+        add_number(record, "median_ns", timing.median_ns);
+        add_number(record, "p90_ns", timing.p90_ns);
+        add_number(record, "p99_ns", timing.p99_ns);
+        add_number(record, "ns_per_element", timing.ns_per_element());
+      } else {
+        for (const char *name : {"timing_repetitions", "min_ns", "median_ns",
+                                 "p90_ns", "p99_ns", "ns_per_element"}) {
+          add_null(record, name);
+        }
+      }
+      add_optional(record, "instructions", result.counters.instructions);
+      add_optional(record, "cycles", result.counters.cycles);
+      add_optional(record, "branch_misses", result.counters.branch_misses);
+      add_optional(record, "l1d_misses", result.counters.l1d_misses);
+      add_optional(record, "llc_misses", result.counters.llc_misses);
+
+      add_text(record, "fit_metric",
+               options.estimate_based_on_comparisons ? "comparisons"
+                                                     : "data_moves");
+      if (fit.points >= 2) {
+        add_text(record, "fit_model",
+                 testing_complexity::growth_model_to_string(fit.model));
+        add_number(record, "fit_constant", fit.constant);
+        if (fit.model == testing_complexity::GrowthModel::PowerLaw) {
+          add_number(record, "fit_exponent", fit.exponent);
+        } else {
+          add_null(record, "fit_exponent");
+        }
+        add_number(record, "fit_r_squared", fit.r_squared);
+      } else {
+        for (const char *name :
+             {"fit_model", "fit_constant", "fit_exponent", "fit_r_squared"}) {
+          add_null(record, name);
+        }
+      }
+      add_text(record, "best_case_type", estimate.best_case_type);
+      add_text(record, "best_case_complexity",
+               testing_complexity::complexity_to_string(estimate.best_case));
+      add_text(record, "worst_case_type", estimate.worst_case_type);
+      add_text(record, "worst_case_complexity",
+               testing_complexity::complexity_to_string(estimate.worst_case));
+
+      add_text(record, "compiler", metadata.compiler);
+      add_text(record, "build", metadata.build);
+      add_text(record, "cxx_standard", metadata.cxx_standard);
+      add_text(record, "cpu_model", metadata.cpu_model);
+      add_number(record, "hardware_threads",
+                 (unsigned long long)metadata.hardware_threads);
+      add_text(record, "os", metadata.os);
+      add_text(record, "started", metadata.started);
+      records.push_back(record);
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(files_lock);
+  if (!options.json_path.empty()) {
+    if (OpenFile *file = open_file(options.json_path)) {
+      for (const Record &record : records) {
+        write_json(file->out, record);
+      }
+      file->written = true;
+      file->out.flush();
+    }
+  }
+  if (!options.csv_path.empty()) {
+    if (OpenFile *file = open_file(options.csv_path)) {
+      for (const Record &record : records) {
+        write_csv(file->out, record, !file->written);
+        file->written = true;
+      }
+      file->out.flush();
+    }
+  }
+}
+} // namespace testing_export
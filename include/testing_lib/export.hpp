@@ -0,0 +1,38 @@
+#ifndef CINDY_TESTING_FRAMEWORK_EXPORT_H
+#define CINDY_TESTING_FRAMEWORK_EXPORT_H
+#include "complexity.hpp"
+#include "framework.hpp"
+#include "prelude.hpp"
+#include <string>
+namespace testing_export {
+using testing_complexity::ComplexityEstimate;
+using testing_framework::TestOptions;
+PRELUDE;
+
+// Where the harness was built and is running, repeated in every record so
+// that files from different machines or builds can be concatenated.
+struct RunMetadata {
+  std::string compiler;     // E.g. "gcc 13.2.0"
+  std::string build;        // "optimized" or "unoptimized", plus NDEBUG
+  std::string cxx_standard; // __cplusplus
+  std::string cpu_model;    // "unknown" where it cannot be read
+  unsigned hardware_threads;
+  std::string os;
+  std::string started; // UTC, ISO 8601
+};
+
+// Gathered on first use.
+const RunMetadata &run_metadata();
+
+// Writes one record per case in results to options.json_path (JSON lines)
+// and options.csv_path (CSV with a header row), whichever are set: the
+// algorithm, input type, size, run and case seed, every Control counter,
+// timing and hardware counters (null / empty when not measured), the fit
+// of that input type's costs, estimate, and run_metadata(). A file that
+// cannot be opened is reported on std::cerr and skipped.
+void export_results(const std::string &algorithm, const ResultsMap &results,
+                    const TestOptions &options,
+                    const ComplexityEstimate &estimate);
+} // namespace testing_export
+
+#endif
@@ -1,17 +1,17 @@
 #include "framework.hpp"
+#include <algorithm>
 #include <iostream>
 namespace testing_framework {
-void ControlStatsSnapshot::print() const {
-  std::cout << "--- Control Stats Snapshot ---" << std::endl;
-  std::cout << "  < : " << less_than_count << ", > : " << greater_than_count
-            << ", <=: " << less_equal_count << ", >=: " << greater_equal_count
-            << ", ==: " << equal_count << ", !=: " << not_equal_count
-            << std::endl;
-  std::cout << "  CopyCtor: " << copy_constructor_count
-            << ", CopyAssign: " << copy_assignment_count
-            << ", MoveCtor: " << move_constructor_count
-            << ", MoveAssign: " << move_assignment_count << std::endl;
-  std::cout << "----------------------------" << std::endl;
+void ControlStatsSnapshot::print(std::ostream &os) const {
+  os << "--- Control Stats Snapshot ---" << std::endl;
+  os << "  < : " << less_than_count << ", > : " << greater_than_count
+     << ", <=: " << less_equal_count << ", >=: " << greater_equal_count
+     << ", ==: " << equal_count << ", !=: " << not_equal_count << std::endl;
+  os << "  CopyCtor: " << copy_constructor_count
+     << ", CopyAssign: " << copy_assignment_count
+     << ", MoveCtor: " << move_constructor_count
+     << ", MoveAssign: " << move_assignment_count << std::endl;
+  os << "----------------------------" << std::endl;
 }
 
 // Helper to get total comparisons
@@ -26,81 +26,219 @@ unsigned long long ControlStatsSnapshot::total_data_moves() const {
   return copy_constructor_count + copy_assignment_count +
          move_constructor_count + move_assignment_count;
 }
+void HardwareCounters::print(std::ostream &os) const {
+  auto field = [&os](const char *name,
+                      const std::optional<unsigned long long> &value) {
+    os << name << ": ";
+    if (value) {
+      os << *value;
+    } else {
+      os << "n/a";
+    }
+  };
+  os << "  ";
+  field("Instructions", instructions);
+  os << ", ";
+  field("Cycles", cycles);
+  os << ", ";
+  field("BranchMisses", branch_misses);
+  os << ", ";
+  field("L1dMisses", l1d_misses);
+  os << ", ";
+  field("LLCMisses", llc_misses);
+  os << std::endl;
+}
+
+double TimingStats::ns_per_element() const {
+  return array_size > 0 ? median_ns / array_size : 0;
+}
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+Control::Control()
+    : less_than_count(*this, LessThan), greater_than_count(*this, GreaterThan),
+      less_equal_count(*this, LessEqual),
+      greater_equal_count(*this, GreaterEqual), equal_count(*this, Equal),
+      not_equal_count(*this, NotEqual),
+      copy_constructor_count(*this, CopyConstructor),
+      copy_assignment_count(*this, CopyAssignment),
+      move_constructor_count(*this, MoveConstructor),
+      move_assignment_count(*this, MoveAssignment) {}
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
 Control &Control::get_instance() {
   static Control instance;
   return instance;
 }
 
-void Control::increment_less_than() { ++less_than_count; }
+struct Control::ShardOwner {
+  Shard *shard;
 
-void Control::increment_greater_than() { ++greater_than_count; }
+  ShardOwner() : shard(new Shard()) {
+    Control &control = get_instance();
+    std::lock_guard<std::mutex> guard(control.shards_lock);
+    control.shards.push_back(shard);
+  }
 
-void Control::increment_less_equal() { ++less_equal_count; }
+  ~ShardOwner() {
+    Control &control = get_instance();
+    std::lock_guard<std::mutex> guard(control.shards_lock);
+    for (int i = 0; i < CounterCount; i++) {
+      control.retired[i] += shard->counts[i].load(std::memory_order_relaxed);
+    }
+    control.shards.erase(
+        std::find(control.shards.begin(), control.shards.end(), shard));
+    delete shard;
+  }
+};
 
-void Control::increment_greater_equal() { ++greater_equal_count; }
+thread_local Control::Shard *Control::current_shard = nullptr;
+thread_local ComparisonHook *Control::current_hook = nullptr;
 
-void Control::increment_equal() { ++equal_count; }
+void Control::set_comparison_hook(ComparisonHook *hook) {
+  current_hook = hook;
+}
 
-void Control::increment_not_equal() { ++not_equal_count; }
+ComparisonHook *Control::comparison_hook() { return current_hook; }
 
-void Control::increment_copy_constructor() { ++copy_constructor_count; }
+Control::Shard *Control::register_thread() {
+  static thread_local ShardOwner owner;
+  current_shard = owner.shard;
+  return current_shard;
+}
 
-void Control::increment_copy_assignment() { ++copy_assignment_count; }
+inline Control::Shard &Control::local_shard() {
+  Shard *shard = current_shard;
+  return shard != nullptr ? *shard : *register_thread();
+}
 
-void Control::increment_move_constructor() { ++move_constructor_count; }
+void Control::totals(unsigned long long out[CounterCount]) const {
+  for (int i = 0; i < CounterCount; i++) {
+    out[i] = retired[i];
+  }
+  for (const Shard *shard : shards) {
+    for (int i = 0; i < CounterCount; i++) {
+      out[i] += shard->counts[i].load(std::memory_order_relaxed);
+    }
+  }
+}
+
+ControlStatsSnapshot
+Control::to_snapshot(const unsigned long long counts[CounterCount]) {
+  ControlStatsSnapshot snapshot;
+  snapshot.less_than_count = counts[LessThan];
+  snapshot.greater_than_count = counts[GreaterThan];
+  snapshot.less_equal_count = counts[LessEqual];
+  snapshot.greater_equal_count = counts[GreaterEqual];
+  snapshot.equal_count = counts[Equal];
+  snapshot.not_equal_count = counts[NotEqual];
+  snapshot.copy_constructor_count = counts[CopyConstructor];
+  snapshot.copy_assignment_count = counts[CopyAssignment];
+  snapshot.move_constructor_count = counts[MoveConstructor];
+  snapshot.move_assignment_count = counts[MoveAssignment];
+  return snapshot;
+}
+
+void Control::increment_less_than() { local_shard().increment(LessThan); }
+
+void Control::increment_greater_than() {
+  local_shard().increment(GreaterThan);
+}
+
+void Control::increment_less_equal() { local_shard().increment(LessEqual); }
+
+void Control::increment_greater_equal() {
+  local_shard().increment(GreaterEqual);
+}
 
-void Control::increment_move_assignment() { ++move_assignment_count; }
+void Control::increment_equal() { local_shard().increment(Equal); }
+
+void Control::increment_not_equal() { local_shard().increment(NotEqual); }
+
+void Control::increment_copy_constructor() {
+  local_shard().increment(CopyConstructor);
+}
+
+void Control::increment_copy_assignment() {
+  local_shard().increment(CopyAssignment);
+}
+
+void Control::increment_move_constructor() {
+  local_shard().increment(MoveConstructor);
+}
+
+void Control::increment_move_assignment() {
+  local_shard().increment(MoveAssignment);
+}
 
 void Control::print_stats() const {
+  unsigned long long counts[CounterCount];
+  {
+    std::lock_guard<std::mutex> guard(shards_lock);
+    totals(counts);
+  }
+  for (int i = 0; i < CounterCount; i++) {
+    counts[i] -= baseline[i];
+  }
   std::cout << "--- Operation Stats (Singleton Control) ---" << std::endl;
   std::cout << "Comparisons:" << std::endl;
-  std::cout << "  < : " << less_than_count << std::endl;
-  std::cout << "  > : " << greater_than_count << std::endl;
-  std::cout << "  <=: " << less_equal_count << std::endl;
-  std::cout << "  >=: " << greater_equal_count << std::endl;
-  std::cout << "  ==: " << equal_count << std::endl;
-  std::cout << "  !=: " << not_equal_count << std::endl;
+  std::cout << "  < : " << counts[LessThan] << std::endl;
+  std::cout << "  > : " << counts[GreaterThan] << std::endl;
+  std::cout << "  <=: " << counts[LessEqual] << std::endl;
+  std::cout << "  >=: " << counts[GreaterEqual] << std::endl;
+  std::cout << "  ==: " << counts[Equal] << std::endl;
+  std::cout << "  !=: " << counts[NotEqual] << std::endl;
   std::cout << "Object Lifecycle:" << std::endl;
-  std::cout << "  Copy Constructions: " << copy_constructor_count << std::endl;
-  std::cout << "  Copy Assignments  : " << copy_assignment_count << std::endl;
-  std::cout << "  Move Constructions: " << move_constructor_count << std::endl;
-  std::cout << "  Move Assignments  : " << move_assignment_count << std::endl;
+  std::cout << "  Copy Constructions: " << counts[CopyConstructor] << std::endl;
+  std::cout << "  Copy Assignments  : " << counts[CopyAssignment] << std::endl;
+  std::cout << "  Move Constructions: " << counts[MoveConstructor] << std::endl;
+  std::cout << "  Move Assignments  : " << counts[MoveAssignment] << std::endl;
   std::cout << "-------------------------------------------" << std::endl;
 }
 
 ControlStatsSnapshot Control::reset_and_get_snapshot() {
-  ControlStatsSnapshot snapshot;
-
-  // 1. Capture current values into the snapshot
-  snapshot.less_than_count = this->less_than_count;
-  snapshot.greater_than_count = this->greater_than_count;
-  snapshot.less_equal_count = this->less_equal_count;
-  snapshot.greater_equal_count = this->greater_equal_count;
-  snapshot.equal_count = this->equal_count;
-  snapshot.not_equal_count = this->not_equal_count;
+  unsigned long long counts[CounterCount];
+  std::lock_guard<std::mutex> guard(shards_lock);
+  totals(counts);
+  for (int i = 0; i < CounterCount; i++) {
+    unsigned long long total = counts[i];
+    counts[i] -= baseline[i];
+    baseline[i] = total;
+  }
+  return to_snapshot(counts);
+}
 
-  snapshot.copy_constructor_count = this->copy_constructor_count;
-  snapshot.copy_assignment_count = this->copy_assignment_count;
-  snapshot.move_constructor_count = this->move_constructor_count;
-  snapshot.move_assignment_count = this->move_assignment_count;
+void Control::reset_stats() { reset_and_get_snapshot(); }
 
-  // 2. Reset the stats in the singleton instance
-  this->reset_stats(); // Call the reset_stats member function
+Control::LegacyCounter::operator unsigned long long() const {
+  unsigned long long counts[CounterCount];
+  std::lock_guard<std::mutex> guard(control.shards_lock);
+  control.totals(counts);
+  return counts[counter] - control.baseline[counter];
+}
 
-  return snapshot;
+Control::LegacyCounter &
+Control::LegacyCounter::operator=(unsigned long long value) {
+  unsigned long long counts[CounterCount];
+  std::lock_guard<std::mutex> guard(control.shards_lock);
+  control.totals(counts);
+  control.baseline[counter] = counts[counter] - value;
+  return *this;
 }
 
-void Control::reset_stats() {
-  less_than_count = 0;
-  greater_than_count = 0;
-  less_equal_count = 0;
-  greater_equal_count = 0;
-  equal_count = 0;
-  not_equal_count = 0;
-  copy_constructor_count = 0;
-  copy_assignment_count = 0;
-  move_constructor_count = 0;
-  move_assignment_count = 0;
+ControlStatsSnapshot Control::reset_and_get_thread_snapshot() {
+  Shard &shard = local_shard();
+  unsigned long long counts[CounterCount];
+  for (int i = 0; i < CounterCount; i++) {
+    unsigned long long total = shard.counts[i].load(std::memory_order_relaxed);
+    counts[i] = total - shard.thread_baseline[i];
+    shard.thread_baseline[i] = total;
+  }
+  return to_snapshot(counts);
 }
 
 // --- Definitions for class Testing ---
@@ -166,46 +304,54 @@ int Testing::get_value() const { return value; }
 
 // --- Definitions for free functions (operators for Testing) ---
 
+// Three-way comparison of the values, or the hook's verdict if one is set.
+static inline int compare_values(const Testing &lhs, const Testing &rhs) {
+  if (ComparisonHook *hook = Control::comparison_hook()) {
+    return hook->compare(lhs.value, rhs.value);
+  }
+  return (lhs.value > rhs.value) - (lhs.value < rhs.value);
+}
+
 bool operator<(const Testing &lhs, const Testing &rhs) {
   if (lhs.control) { // Accessing member 'control', ok since declared friend
     lhs.control->increment_less_than();
   }
-  return lhs.value < rhs.value;
+  return compare_values(lhs, rhs) < 0;
 }
 
 bool operator>(const Testing &lhs, const Testing &rhs) {
   if (lhs.control) {
     lhs.control->increment_greater_than();
   }
-  return lhs.value > rhs.value;
+  return compare_values(lhs, rhs) > 0;
 }
 
 bool operator<=(const Testing &lhs, const Testing &rhs) {
   if (lhs.control) {
     lhs.control->increment_less_equal();
   }
-  return lhs.value <= rhs.value;
+  return compare_values(lhs, rhs) <= 0;
 }
 
 bool operator>=(const Testing &lhs, const Testing &rhs) {
   if (lhs.control) {
     lhs.control->increment_greater_equal();
   }
-  return lhs.value >= rhs.value;
+  return compare_values(lhs, rhs) >= 0;
 }
 
 bool operator==(const Testing &lhs, const Testing &rhs) {
   if (lhs.control) {
     lhs.control->increment_equal();
   }
-  return lhs.value == rhs.value;
+  return compare_values(lhs, rhs) == 0;
 }
 
 bool operator!=(const Testing &lhs, const Testing &rhs) {
   if (lhs.control) {
     lhs.control->increment_not_equal();
   }
-  return lhs.value != rhs.value;
+  return compare_values(lhs, rhs) != 0;
 }
 
 std::ostream &operator<<(std::ostream &os, const Testing &obj) {
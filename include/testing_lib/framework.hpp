@@ -1,7 +1,10 @@
 #ifndef CINDY_TESTING_FRAMEWORK_H
 #define CINDY_TESTING_FRAMEWORK_H
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <optional>
+#include <string>
 #include <vector>
 namespace testing_framework {
 struct ControlStatsSnapshot {
@@ -18,9 +21,37 @@ struct ControlStatsSnapshot {
   unsigned long long move_assignment_count = 0;
   unsigned long long total_comparisons() const;
   unsigned long long total_data_moves() const;
-  void print() const;
+  void print(std::ostream &os = std::cout) const;
 };
 
+// Hardware events counted around one call of the sorting function. A field is
+// empty when that event could not be counted on this machine.
+struct HardwareCounters {
+  bool available = false; // At least one event was counted
+  std::optional<unsigned long long> instructions;
+  std::optional<unsigned long long> cycles;
+  std::optional<unsigned long long> branch_misses;
+  std::optional<unsigned long long> l1d_misses;
+  std::optional<unsigned long long> llc_misses;
+  void print(std::ostream &os = std::cout) const;
+};
+
+// While installed on a thread, decides the outcome of every Testing
+// comparison made on that thread: compare gets the two values and returns a
+// negative number, zero or a positive number like a three-way comparison.
+// Lets an adversary choose the order of elements as a sort inspects them.
+class ComparisonHook {
+public:
+  virtual ~ComparisonHook() = default;
+  virtual int compare(int lhs, int rhs) = 0;
+};
+
+// Counts the operations Testing performs. Every thread increments its own
+// shard of counters, padded to whole cache lines, so parallel sorts neither
+// race on the counts nor bounce a shared line between cores; the snapshots
+// add the shards up. Shards only ever count upwards: a reset records the
+// current totals as the new baseline instead of clearing other threads'
+// counters, and a thread's counts are folded into retired when it exits.
 class Control {
 public:
   Control(const Control &) = delete;
@@ -30,17 +61,6 @@ public:
 
   static Control &get_instance();
 
-  unsigned long long less_than_count = 0;
-  unsigned long long greater_than_count = 0;
-  unsigned long long less_equal_count = 0;
-  unsigned long long greater_equal_count = 0;
-  unsigned long long equal_count = 0;
-  unsigned long long not_equal_count = 0;
-  unsigned long long copy_constructor_count = 0;
-  unsigned long long copy_assignment_count = 0;
-  unsigned long long move_constructor_count = 0;
-  unsigned long long move_assignment_count = 0;
-
   void increment_less_than();
   void increment_greater_than();
   void increment_less_equal();
@@ -55,11 +75,99 @@ public:
 
   void print_stats() const;
 
+  // Counts of all threads since the previous reset. Exact once the threads
+  // that did the counting have been joined.
   ControlStatsSnapshot reset_and_get_snapshot();
   void reset_stats();
 
+  // Counts of the calling thread alone since its previous call, so threads
+  // running independent cases do not see each other's operations.
+  ControlStatsSnapshot reset_and_get_thread_snapshot();
+
+  // Hook for the calling thread's Testing comparisons; nullptr restores
+  // plain value comparisons.
+  void set_comparison_hook(ComparisonHook *hook);
+  static ComparisonHook *comparison_hook();
+
 private:
-  Control() = default;
+  enum Counter {
+    LessThan,
+    GreaterThan,
+    LessEqual,
+    GreaterEqual,
+    Equal,
+    NotEqual,
+    CopyConstructor,
+    CopyAssignment,
+    MoveConstructor,
+    MoveAssignment,
+    CounterCount
+  };
+
+  struct alignas(64) Shard {
+    // Written by the owning thread only, read by snapshots.
+    std::atomic<unsigned long long> counts[CounterCount] = {};
+    unsigned long long thread_baseline[CounterCount] = {}; // Owner only
+
+    void increment(Counter counter) {
+      counts[counter].store(counts[counter].load(std::memory_order_relaxed) +
+                                1,
+                            std::memory_order_relaxed);
+    }
+  };
+  struct ShardOwner; // Registers a thread's shard, retires it on exit
+
+  // Plain pointer so the hot path needs no thread_local init guard.
+  static thread_local Shard *current_shard;
+  static thread_local ComparisonHook *current_hook;
+
+  mutable std::mutex shards_lock;
+  std::vector<Shard *> shards;
+  unsigned long long retired[CounterCount] = {};
+  unsigned long long baseline[CounterCount] = {};
+
+  Control(); // Out of line, where it may name the deprecated counters
+  Shard &local_shard();
+  static Shard *register_thread(); // Slow path of local_shard
+  void totals(unsigned long long out[CounterCount]) const; // Holds the lock
+  static ControlStatsSnapshot
+  to_snapshot(const unsigned long long counts[CounterCount]);
+
+public:
+  // Stands in for one of the public counter fields Control used to have:
+  // reads give the count of all threads since the previous reset, like
+  // reset_and_get_snapshot() without the reset, and assigning moves that
+  // counter's baseline so it reads back as the assigned value.
+  class LegacyCounter {
+  public:
+    operator unsigned long long() const;
+    LegacyCounter &operator=(unsigned long long value);
+    LegacyCounter(const LegacyCounter &) = delete;
+
+  private:
+    friend class Control;
+    LegacyCounter(Control &control, Counter counter)
+        : control(control), counter(counter) {}
+    Control &control;
+    const Counter counter;
+  };
+
+  [[deprecated("use reset_and_get_snapshot()")]] LegacyCounter less_than_count;
+  [[deprecated("use reset_and_get_snapshot()")]] LegacyCounter
+      greater_than_count;
+  [[deprecated("use reset_and_get_snapshot()")]] LegacyCounter less_equal_count;
+  [[deprecated("use reset_and_get_snapshot()")]] LegacyCounter
+      greater_equal_count;
+  [[deprecated("use reset_and_get_snapshot()")]] LegacyCounter equal_count;
+  [[deprecated("use reset_and_get_snapshot()")]] LegacyCounter not_equal_count;
+  [[deprecated("use reset_and_get_snapshot()")]] LegacyCounter
+      copy_constructor_count;
+  [[deprecated("use reset_and_get_snapshot()")]] LegacyCounter
+      copy_assignment_count;
+  [[deprecated("use reset_and_get_snapshot()")]] LegacyCounter
+      move_constructor_count;
+  [[deprecated("use reset_and_get_snapshot()")]] LegacyCounter
+      move_assignment_count;
 };
 
 class Testing {
@@ -97,13 +205,28 @@ bool operator==(const Testing &lhs, const Testing &rhs);
 bool operator!=(const Testing &lhs, const Testing &rhs);
 std::ostream &operator<<(std::ostream &os, const Testing &obj);
 
+// Wall-clock statistics over the timed repetitions of one test case.
+struct TimingStats {
+  int repetitions = 0; // 0 when timing was off
+  int array_size = 0;
+  double min_ns = 0;
+  double median_ns = 0;
+  double p90_ns = 0;
+  double p99_ns = 0;
+  double ns_per_element() const; // Based on the median
+};
+
 struct SortingResult {
   ControlStatsSnapshot snapshot;
+  HardwareCounters counters;
+  TimingStats timing;
   bool sorted;
   std::string test_case_name;
   int array_size;
 };
 
+const unsigned long long DefaultInputSeed = 20240601;
+
 enum class Complexity { O1, ON, ONLogN, ON2, Undetermined, InsufficientData };
 struct TestOptions {
   std::vector<int> sizes = {10, 50, 100, /*200, 500, 1000, 2000, 5000, 10000*/};
@@ -116,6 +239,39 @@ struct TestOptions {
       std::nullopt; // Optional expected best case
   std::optional<Complexity> expected_worst_complexity =
       std::nullopt; // Optional expected worst case
+
+  // Seed for the generated inputs; every case derives its own from it, so a
+  // run is reproducible and any single case can be replayed.
+  unsigned long long seed = DefaultInputSeed;
+
+  // --- Adversary Options ---
+  bool adversary = false; // Also build McIlroy killer inputs for each size
+
+  // --- Hardware Counter Options ---
+  bool hardware_counters = false; // perf_event_open around each sort (Linux)
+
+  // --- Timing Options ---
+  bool timing = false;        // Also measure wall-clock time per case
+  int timing_warmups = 1;     // Untimed runs before measuring
+  int timing_repetitions = 9; // Timed runs, each on a fresh copy of the input
+
+  // --- Failure Log Options ---
+  int log_differences = 8;  // Positions differing from the sorted input shown
+  int log_context = 3;      // Elements shown either side of each of them
+  int log_array_limit = 40; // Longer arrays are logged as head ... tail
+
+  // --- Parallel Options ---
+  // Cases run on this many threads, each counted on its own Control shard,
+  // so a sort that itself spreads work over threads needs threads = 1.
+  int threads = 1;
+  bool serialize_timed_cases = true; // Time after the pool has stopped
+
+  // --- Export Options ---
+  // Every case is also written to these files when set: one JSON object per
+  // line, or one CSV row. Algorithms given the same path share the file,
+  // which the run truncates the first time it writes to it.
+  std::string json_path;
+  std::string csv_path;
 };
 
 } // namespace testing_framework
@@ -3,80 +3,239 @@
 #include "framework.hpp"
 #include "prelude.hpp"
 #include <algorithm>
+#include <cmath>
 #include <random>
+#include <string>
+#include <utility>
+#include <vector>
 namespace testing_functions {
 PRELUDE;
 using testing_framework::Control;
 using testing_framework::ControlStatsSnapshot;
 using testing_framework::Testing;
-inline Testing *reversed(int size) {
-  if (size <= 0)
-    return nullptr;
-  Testing *arr = new Testing[size];
+
+// Input distributions. A filler writes size values into a caller owned
+// buffer, drawing any randomness from rng, so the harness can reuse one
+// buffer for every case and replay any case from its seed. Only raw engine
+// output is used (no std:: distributions or std::shuffle, whose results
+// differ between standard libraries), so a seed means the same input
+// everywhere. Values are assigned directly so Control counts nothing.
+using Random = std::mt19937_64;
+using ArrayFiller = std::function<void(Testing[], int, Random &)>;
+
+// Uniform in [0, bound) by multiply-shift; the bias is below 2^-32.
+inline int uniform_below(Random &rng, int bound) {
+  return int(((rng() >> 32) * (unsigned long long)bound) >> 32);
+}
+
+// Uniform in [0, 1).
+inline double uniform_unit(Random &rng) {
+  return double(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+inline void shuffle(Testing arr[], int size, Random &rng) {
+  for (int i = size - 1; i > 0; i--) {
+    std::swap(arr[i].value, arr[uniform_below(rng, i + 1)].value);
+  }
+}
+
+// Seed of one case, derived from the run seed and the case's name and size
+// (FNV-1a, then the splitmix64 finalizer) so that a case gets the same input
+// whatever else runs and in whichever order.
+inline unsigned long long case_seed(unsigned long long seed,
+                                    const std::string &name, int size) {
+  unsigned long long hash = 14695981039346656037ull ^ seed;
+  for (char c : name) {
+    hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+  }
+  hash = (hash ^ (unsigned long long)size) * 1099511628211ull;
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+  return hash ^ (hash >> 31);
+}
+
+inline void fill_sorted(Testing arr[], int size, Random &) {
   for (int i = 0; i < size; i++) {
+    arr[i].value = i;
+  }
+}
 
-    arr[i] = Testing(size - 1 - i);
+inline void fill_reversed(Testing arr[], int size, Random &) {
+  for (int i = 0; i < size; i++) {
+    arr[i].value = size - 1 - i;
   }
-  return arr;
 }
-inline Testing *sorted(int size) {
-  if (size <= 0)
-    return nullptr;
-  Testing *arr = new Testing[size];
+
+inline void fill_random_unique(Testing arr[], int size, Random &rng) {
+  fill_sorted(arr, size, rng);
+  shuffle(arr, size, rng);
+}
+
+inline void fill_few_unique(Testing arr[], int size, Random &rng) {
+  int num_unique = std::max(2, size / 10);
   for (int i = 0; i < size; i++) {
-    arr[i] = Testing(i);
+    arr[i].value = uniform_below(rng, num_unique);
   }
-  return arr;
 }
 
-inline Testing *random_unique(int size) {
-  if (size <= 0)
-    return nullptr;
-  Testing *arr = new Testing[size];
+inline void fill_nearly_sorted(Testing arr[], int size, Random &rng) {
+  fill_sorted(arr, size, rng);
+  if (size < 2) {
+    return;
+  }
+  int num_swaps = std::max(1, size / 20);
+  for (int i = 0; i < num_swaps; ++i) {
+    std::swap(arr[uniform_below(rng, size)].value,
+              arr[uniform_below(rng, size)].value);
+  }
+}
+
+// Zipf (s = 1) over size ranks: value r turns up about 1/(r+1) as often as
+// value 0, like word or key frequencies in real data. Ranks past the table
+// of the first 2^20 are found from H(r) ~ ln r + gamma instead, so a 10^8
+// element input does not need a 10^8 entry table.
+inline void fill_zipf(Testing arr[], int size, Random &rng) {
+  const int table_ranks = std::min(size, 1 << 20);
+  const double euler_gamma = 0.5772156649015329;
+  std::vector<double> cdf(table_ranks);
+  double total = 0;
+  for (int r = 0; r < size; r++) {
+    total += 1.0 / (r + 1);
+    if (r < table_ranks) {
+      cdf[r] = total;
+    }
+  }
   for (int i = 0; i < size; i++) {
-    arr[i] = Testing(i);
+    double target = uniform_unit(rng) * total;
+    int rank;
+    if (target < cdf.back()) {
+      rank =
+          int(std::upper_bound(cdf.begin(), cdf.end(), target) - cdf.begin());
+    } else {
+      rank = int(std::min(double(size - 1),
+                          std::max(double(table_ranks),
+                                   std::exp(target - euler_gamma))));
+    }
+    arr[i].value = std::min(rank, size - 1);
   }
+}
 
-  std::random_device rd;
-  std::mt19937 g(rd());
-  std::shuffle(arr, arr + size, g);
-  return arr;
+// 0, 1, 2, ..., up to the middle and back down again.
+inline void fill_organ_pipe(Testing arr[], int size, Random &) {
+  for (int i = 0; i < size; i++) {
+    arr[i].value = std::min(i, size - 1 - i);
+  }
 }
-inline Testing *few_unique(int size) {
-  if (size <= 0)
-    return nullptr;
-  int num_unique = std::max(1, size / 10);
-  if (num_unique <= 1 && size > 1)
-    num_unique = 2;
-  Testing *arr = new Testing[size];
-  std::random_device rd;
-  std::mt19937 g(rd());
-  std::uniform_int_distribution<> distrib(0, num_unique - 1);
+
+// About sqrt(size) ascending teeth of equal length.
+inline void fill_sawtooth(Testing arr[], int size, Random &) {
+  int period = std::max(2, int(std::sqrt(double(size))));
   for (int i = 0; i < size; i++) {
-    arr[i] = Testing(distrib(g));
+    arr[i].value = i % period;
   }
-  return arr;
 }
 
-inline Testing *nearly_sorted(int size) {
-  if (size <= 0)
-    return nullptr;
-  Testing *arr = sorted(size);
-  if (size < 2)
-    return arr;
+inline void fill_all_equal(Testing arr[], int size, Random &) {
+  for (int i = 0; i < size; i++) {
+    arr[i].value = 42;
+  }
+}
 
-  int num_swaps = std::max(1, size / 20);
-  std::random_device rd;
-  std::mt19937 g(rd());
-  std::uniform_int_distribution<> distrib(0, size - 1);
+inline void fill_zero_one(Testing arr[], int size, Random &rng) {
+  for (int i = 0; i < size; i++) {
+    arr[i].value = int(rng() >> 63);
+  }
+}
 
-  for (int i = 0; i < num_swaps; ++i) {
-    int idx1 = distrib(g);
-    int idx2 = distrib(g);
+// Median-of-3 killer for the pivot rule of QuicksortHoareImprovedMedian3:
+// median of the first, middle ((start + end) / 2) and last element, then a
+// Hoare partition. The first and middle element of every range get the two
+// smallest values left, so the median is the second smallest and each
+// partition splits off only those two, about n^2 / 4 comparisons in all.
+// The partition moves the element after the first into the middle slot,
+// which the positions below follow.
+inline void fill_median_of_3_killer(Testing arr[], int size, Random &) {
+  std::vector<int> position(size);
+  for (int i = 0; i < size; i++) {
+    position[i] = i;
+  }
+  int next = 0;
+  int start = 0;
+  const int end = size - 1;
+  for (; end - start >= 2; start += 2) {
+    int mid = (start + end) / 2;
+    arr[position[start]].value = next++;
+    arr[position[mid]].value = next++;
+    std::swap(position[start + 1], position[mid]);
+  }
+  for (; start <= end; start++) {
+    arr[position[start]].value = next++;
+  }
+}
 
-    std::swap(arr[idx1], arr[idx2]);
+// Sorted runs of random length covering about 90% of the input, then a
+// random tail: appending fresh records to already sorted batches.
+inline void fill_runs_random_tail(Testing arr[], int size, Random &rng) {
+  int tail = size / 10;
+  int max_run = std::max(2, size / 8);
+  for (int i = 0; i < size; i++) {
+    arr[i].value = uniform_below(rng, std::max(1, size));
+  }
+  for (int start = 0; start < size - tail;) {
+    int end = std::min(size - tail, start + 1 + uniform_below(rng, max_run));
+    std::sort(arr + start, arr + end, [](const Testing &a, const Testing &b) {
+      return a.value < b.value;
+    });
+    start = end;
   }
+}
+
+// Every distribution the harness runs, in report order.
+inline const std::vector<std::pair<std::string, ArrayFiller>> &
+distributions() {
+  static const std::vector<std::pair<std::string, ArrayFiller>> all = {
+      {"Reversed", fill_reversed},
+      {"Sorted", fill_sorted},
+      {"Random Unique", fill_random_unique},
+      {"Few Unique", fill_few_unique},
+      {"Nearly Sorted", fill_nearly_sorted},
+      {"Zipf", fill_zipf},
+      {"Organ Pipe", fill_organ_pipe},
+      {"Sawtooth", fill_sawtooth},
+      {"All Equal", fill_all_equal},
+      {"Zero One", fill_zero_one},
+      {"Median3 Killer", fill_median_of_3_killer},
+      {"Runs + Tail", fill_runs_random_tail},
+  };
+  return all;
+}
+
+// Allocating versions of the original five generators, seeded from
+// DefaultInputSeed. The caller owns the returned array.
+inline Testing *generate(const ArrayFiller &filler, const std::string &name,
+                         int size) {
+  if (size <= 0)
+    return nullptr;
+  Testing *arr = new Testing[size];
+  Random rng(case_seed(testing_framework::DefaultInputSeed, name, size));
+  filler(arr, size, rng);
   return arr;
 }
+
+inline Testing *reversed(int size) {
+  return generate(fill_reversed, "Reversed", size);
+}
+inline Testing *sorted(int size) {
+  return generate(fill_sorted, "Sorted", size);
+}
+inline Testing *random_unique(int size) {
+  return generate(fill_random_unique, "Random Unique", size);
+}
+inline Testing *few_unique(int size) {
+  return generate(fill_few_unique, "Few Unique", size);
+}
+inline Testing *nearly_sorted(int size) {
+  return generate(fill_nearly_sorted, "Nearly Sorted", size);
+}
 } // namespace testing_functions
 #endif
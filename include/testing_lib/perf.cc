@@ -0,0 +1,136 @@
+#include "perf.hpp"
+#include "framework.hpp"
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace testing_perf {
+#ifdef __linux__
+namespace {
+struct EventSpec {
+  unsigned type;
+  unsigned long long config;
+};
+
+// Same order as the fields filled in by PerfCollector::stop.
+const EventSpec events[] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+};
+
+// Opens spec as the group leader when leader is -1, else as a member of
+// leader's group. Members start enabled and count whenever the leader does.
+int open_event(const EventSpec &spec, int leader) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = spec.type;
+  attr.config = spec.config;
+  attr.disabled = leader < 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return int(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+}
+} // namespace
+
+PerfCollector::PerfCollector() : leader(-1) {
+  for (int i = 0; i < EventCount; i++) {
+    fds[i] = open_event(events[i], leader);
+    if (fds[i] < 0 && reason.empty()) {
+      reason = std::string("perf_event_open: ") + std::strerror(errno);
+    }
+    if (fds[i] >= 0 && leader < 0) {
+      leader = fds[i];
+    }
+  }
+  if (leader >= 0) {
+    reason.clear();
+  }
+}
+
+PerfCollector::~PerfCollector() {
+  for (int fd : fds) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+void PerfCollector::start() {
+  if (leader >= 0) {
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+HardwareCounters PerfCollector::stop() {
+  HardwareCounters counters;
+  counters.available = available();
+  if (leader < 0) {
+    return counters;
+  }
+  ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  // nr, time enabled, time running, then one value per open event in the
+  // order they joined the group. The group is scheduled as a whole, so one
+  // scale factor covers every event; time running 0 means it never fit.
+  unsigned long long values[3 + EventCount];
+  ssize_t got = read(leader, values, sizeof(values));
+  if (got < ssize_t(3 * sizeof(values[0])) || values[2] == 0 ||
+      got < ssize_t((3 + values[0]) * sizeof(values[0]))) {
+    return counters;
+  }
+  std::optional<unsigned long long> counts[EventCount];
+  for (int i = 0, k = 0; i < EventCount; i++) {
+    if (fds[i] < 0) {
+      continue;
+    }
+    unsigned long long count = values[3 + k++];
+    if (values[2] < values[1]) {
+      count = (unsigned long long)(double(count) * values[1] / values[2]);
+    }
+    counts[i] = count;
+  }
+  counters.instructions = counts[0];
+  counters.cycles = counts[1];
+  counters.branch_misses = counts[2];
+  counters.l1d_misses = counts[3];
+  counters.llc_misses = counts[4];
+  return counters;
+}
+#else
+PerfCollector::PerfCollector()
+    : leader(-1), reason("perf_event_open needs Linux") {
+  for (int &fd : fds) {
+    fd = -1;
+  }
+}
+
+PerfCollector::~PerfCollector() {}
+
+void PerfCollector::start() {}
+
+HardwareCounters PerfCollector::stop() { return HardwareCounters(); }
+#endif
+
+bool PerfCollector::available() const { return reason.empty(); }
+
+const std::string &PerfCollector::unavailable_reason() const { return reason; }
+} // namespace testing_perf
@@ -0,0 +1,38 @@
+#ifndef CINDY_TESTING_FRAMEWORK_PERF_H
+#define CINDY_TESTING_FRAMEWORK_PERF_H
+#include "framework.hpp"
+#include <string>
+namespace testing_perf {
+using testing_framework::HardwareCounters;
+
+// Hardware performance counters for the calling thread via Linux
+// perf_event_open. The events are opened as one group, led by the first one
+// that opens, so the kernel counts (and multiplexes) them together and
+// ratios such as instructions per cycle cover the same window. An event
+// that cannot be opened is left out of the group, so a machine without
+// (say) an LLC miss event still reports the others. When nothing can be
+// opened (not Linux, perf_event_paranoid too strict, a container without
+// PMU access) start/stop still work and return counters with
+// available == false; unavailable_reason() says why.
+class PerfCollector {
+public:
+  PerfCollector();
+  ~PerfCollector();
+  PerfCollector(const PerfCollector &) = delete;
+  PerfCollector &operator=(const PerfCollector &) = delete;
+
+  bool available() const;
+  const std::string &unavailable_reason() const;
+
+  void start();
+  HardwareCounters stop();
+
+private:
+  static const int EventCount = 5;
+  int fds[EventCount];
+  int leader; // First of fds that opened, -1 if none
+  std::string reason;
+};
+} // namespace testing_perf
+
+#endif
@@ -1,16 +1,32 @@
 #include "sort.hpp"
+#include "adversary.hpp"
+#include "benchmark.hpp"
 #include "complexity.hpp"
+#include "export.hpp"
 #include "framework.hpp"
 #include "functions.hpp"
+#include "perf.hpp"
 #include "utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <sstream>
+#include <thread>
 namespace testing {
+using testing_benchmark::Clock;
+using testing_benchmark::elapsed_ns;
+using testing_benchmark::percentile;
 using testing_framework::Control;
 using testing_framework::ControlStatsSnapshot;
 using testing_framework::SortingResult;
 using testing_framework::Testing;
 using testing_framework::TestOptions;
+using testing_framework::TimingStats;
+using testing_functions::ArrayFiller;
 using testing_utils::BG_GREEN;
 using testing_utils::BG_RED;
 using testing_utils::BLACK;
@@ -24,97 +40,263 @@ using testing_utils::GREEN;
 using testing_utils::MAGENTA;
 using testing_utils::print_colored;
 using testing_utils::print_colored_line;
-using testing_utils::printArray;
+using testing_utils::printArrayBounded;
 using testing_utils::RED;
 using testing_utils::RESET;
 using testing_utils::WHITE;
 using testing_utils::YELLOW;
 PRELUDE;
-SortingResult test_sort_func_single_case(const ArrayGenerator &generator,
-                                         int size, const std::string &test_name,
-                                         const SortingFunction &funcptr,
-                                         const TestOptions &options) {
-
-  std::stringstream log_buffer;
-  SortingResult result;
-  result.test_case_name = test_name;
-  result.array_size = size;
-  result.sorted = false;
+// Runs funcptr on a fresh copy of input for every warmup and timed
+// repetition; only the sort itself is inside the timed region. The counters
+// in Control still tick during these runs, so the calling thread's shard is
+// cleared afterwards; cases running on other threads keep their counts.
+TimingStats time_sort_func(const Testing input[], int size,
+                           const SortingFunction &funcptr,
+                           const TestOptions &options) {
+  TimingStats timing;
+  timing.array_size = size;
+  std::unique_ptr<Testing[]> work(new Testing[size]);
+  std::vector<double> samples;
+  int runs = options.timing_warmups + options.timing_repetitions;
+  for (int run = 0; run < runs; run++) {
+    std::copy(input, input + size, work.get());
+    Clock::time_point start = Clock::now();
+    funcptr(work.get(), size);
+    double ns = elapsed_ns(start, Clock::now());
+    if (run >= options.timing_warmups) {
+      samples.push_back(ns);
+    }
+  }
+  Control::get_instance().reset_and_get_thread_snapshot();
+
+  if (!samples.empty()) {
+    timing.repetitions = int(samples.size());
+    timing.median_ns = percentile(samples, 50);
+    timing.p90_ns = percentile(samples, 90);
+    timing.p99_ns = percentile(samples, 99);
+    timing.min_ns = samples.front(); // percentile sorted them
+  }
+  return timing;
+}
 
-  std::cout << "-- Running Case: " << test_name << " (Size: " << size << ") --"
-            << std::endl;
+// The timing sensitive part of a case: hardware counters around one sort and
+// the timed repetitions, each on a fresh copy of input.
+void measure_case(const Testing input[], int size,
+                  const SortingFunction &funcptr, const TestOptions &options,
+                  SortingResult &result, std::ostream &out) {
+  if (options.hardware_counters) {
+    // Unavailable counters are reported once, in the algorithm's header.
+    testing_perf::PerfCollector perf;
+    if (perf.available()) {
+      std::unique_ptr<Testing[]> work(new Testing[size]);
+      std::copy(input, input + size, work.get());
+      perf.start();
+      funcptr(work.get(), size);
+      result.counters = perf.stop();
+      out << "  Hardware counters:" << std::endl;
+      result.counters.print(out);
+    }
+  }
 
-  Testing *arr = generator(size);
-  if (!arr) {
-    if (size <= 0) {
-      std::cout << "  Skipped (Size <= 0)" << std::endl;
-      result.snapshot = Control::get_instance().reset_and_get_snapshot();
+  if (options.timing) {
+    result.timing = time_sort_func(input, size, funcptr, options);
+    out << "  Timing: median " << std::fixed << std::setprecision(1)
+        << result.timing.median_ns / 1e3 << " us, "
+        << result.timing.ns_per_element() << " ns/element over "
+        << result.timing.repetitions << " runs" << std::defaultfloat
+        << std::endl;
+  }
+}
 
-      result.sorted = (size <= 1);
-      return result;
-    } else {
-      print_colored_line("  ERROR: Array generator returned nullptr!",
-                         BOLD_RED);
-      result.snapshot = Control::get_instance().reset_and_get_snapshot();
-      result.sorted = false;
-      return result;
+// Writes where arr differs from its sorted input: how many positions do,
+// then the first options.log_differences of them with options.log_context
+// elements either side, actual over expected, overlapping windows merged.
+void print_differences(std::ostream &out, const Testing input[],
+                       const Testing arr[], int size,
+                       const TestOptions &options) {
+  std::vector<int> expected(size);
+  for (int i = 0; i < size; i++) {
+    expected[i] = input[i].get_value();
+  }
+  std::sort(expected.begin(), expected.end());
+
+  std::vector<int> shown;
+  int differing = 0;
+  int descents = 0;
+  for (int i = 0; i < size; i++) {
+    if (arr[i].get_value() != expected[i]) {
+      differing++;
+      if (int(shown.size()) < options.log_differences) {
+        shown.push_back(i);
+      }
+    }
+    if (i > 0 && arr[i].get_value() < arr[i - 1].get_value()) {
+      descents++;
     }
   }
-  std::unique_ptr<Testing[]> arr_ptr(arr);
-
-  log_buffer << "  Initial array: ";
+  out << "  Differences from the sorted input: " << differing << " of " << size
+      << " positions, " << descents << " out of order";
+  if (shown.empty()) {
+    out << std::endl;
+    return;
+  }
+  out << "; first " << shown.size() << ":" << std::endl;
+
+  const int context = std::max(0, options.log_context);
+  for (size_t k = 0; k < shown.size();) {
+    int begin = std::max(0, shown[k] - context);
+    int end = std::min(size, shown[k] + context + 1);
+    while (++k < shown.size() && shown[k] - context <= end) {
+      end = std::min(size, shown[k] + context + 1);
+    }
+    int width = 1;
+    for (int i = begin; i < end; i++) {
+      width = std::max({width, int(std::to_string(arr[i].get_value()).size()),
+                        int(std::to_string(expected[i]).size())});
+    }
+    std::string label = "    at " + std::to_string(begin) + " ";
+    out << label << "actual:  ";
+    for (int i = begin; i < end; i++) {
+      out << " " << std::setw(width) << arr[i].get_value();
+    }
+    out << std::endl << std::string(label.size(), ' ') << "expected:";
+    for (int i = begin; i < end; i++) {
+      out << " " << std::setw(width) << expected[i];
+    }
+    int last_marked = begin;
+    for (int i = begin; i < end; i++) {
+      if (arr[i].get_value() != expected[i]) {
+        last_marked = i;
+      }
+    }
+    out << std::endl << std::string(label.size() + 9, ' ');
+    for (int i = begin; i <= last_marked; i++) {
+      out << " " << std::setw(width)
+          << (arr[i].get_value() != expected[i] ? "^" : "");
+    }
+    out << std::endl;
+  }
+}
 
-  std::streambuf *cout_buf = std::cout.rdbuf();
-  std::cout.rdbuf(log_buffer.rdbuf());
-  printArray(arr_ptr.get(), size);
-  std::cout.rdbuf(cout_buf);
-  log_buffer << std::endl;
+// Runs one case: fills buffer with the case's input, sorts it, counts and
+// verifies, writing its report to out. Passing cases cost no formatting;
+// the input is regenerated from its seed only when a failure or verbose log
+// needs it. With parallel set the counts come from the calling thread's
+// shard only, so cases on other threads do not leak in, and measure says
+// whether to run measure_case now or leave it to the caller.
+SortingResult test_sort_func_single_case(const ArrayFiller &filler,
+                                         Testing buffer[], int size,
+                                         const std::string &test_name,
+                                         const SortingFunction &funcptr,
+                                         const TestOptions &options,
+                                         std::ostream &out, bool parallel,
+                                         bool measure) {
 
-  Control::get_instance().reset_and_get_snapshot();
-  funcptr(arr_ptr.get(), size);
-  result.snapshot = Control::get_instance().reset_and_get_snapshot();
+  SortingResult result;
+  result.test_case_name = test_name;
+  result.array_size = size;
+  result.sorted = false;
+  Control &control = Control::get_instance();
 
-  log_buffer << "  Sorted array:  ";
-  cout_buf = std::cout.rdbuf();
-  std::cout.rdbuf(log_buffer.rdbuf());
-  printArray(arr_ptr.get(), size);
-  std::cout.rdbuf(cout_buf);
-  log_buffer << std::endl;
+  out << "-- Running Case: " << test_name << " (Size: " << size << ") --"
+      << std::endl;
 
-  log_buffer << "  Statistics:" << std::endl;
+  if (size <= 0) {
+    out << "  Skipped (Size <= 0)" << std::endl;
+    result.sorted = true;
+    return result;
+  }
+  const unsigned long long seed =
+      testing_functions::case_seed(options.seed, test_name, size);
+  testing_functions::Random rng(seed);
+  filler(buffer, size, rng);
+  Testing *arr = buffer;
+
+  std::vector<Testing> input;
+  if (measure && (options.timing || options.hardware_counters)) {
+    input.assign(arr, arr + size);
+  }
 
-  cout_buf = std::cout.rdbuf();
-  std::cout.rdbuf(log_buffer.rdbuf());
-  result.snapshot.print();
-  std::cout.rdbuf(cout_buf);
+  if (parallel) {
+    control.reset_and_get_thread_snapshot();
+    funcptr(arr, size);
+    result.snapshot = control.reset_and_get_thread_snapshot();
+  } else {
+    control.reset_and_get_snapshot();
+    funcptr(arr, size);
+    result.snapshot = control.reset_and_get_snapshot();
+  }
 
-  result.sorted = std::is_sorted(arr_ptr.get(), arr_ptr.get() + size);
+  result.sorted = std::is_sorted(arr, arr + size);
 
-  std::cout << "  Verification: ";
+  out << "  Verification: ";
   if (result.sorted) {
-    print_colored_line("Passed", BOLD_GREEN);
+    print_colored_line(out, "Passed", BOLD_GREEN);
   } else {
-    print_colored_line("Failed", BOLD_RED);
+    print_colored_line(out, "Failed", BOLD_RED);
+  }
+
+  if (!input.empty()) {
+    measure_case(input.data(), size, funcptr, options, result, out);
   }
 
   if (!result.sorted || options.verbose) {
     std::string log_header =
         !result.sorted ? "-- Failure Log --" : "-- Verbose Log --";
-    print_colored_line(log_header, !result.sorted ? BOLD_RED : YELLOW);
-
-    std::cout << log_buffer.str();
-    std::cout << "-------------------" << std::endl;
+    print_colored_line(out, log_header, !result.sorted ? BOLD_RED : YELLOW);
+
+    std::unique_ptr<Testing[]> initial(new Testing[size]);
+    testing_functions::Random replay(seed);
+    filler(initial.get(), size, replay);
+    out << "  Case seed:     " << seed << std::endl;
+    out << "  Initial array: ";
+    printArrayBounded(out, initial.get(), size, options.log_array_limit);
+    out << "  Sorted array:  ";
+    printArrayBounded(out, arr, size, options.log_array_limit);
+    out << "  Statistics:" << std::endl;
+    result.snapshot.print(out);
+    if (!result.sorted) {
+      print_differences(out, initial.get(), arr, size, options);
+    }
+    out << "-------------------" << std::endl;
   }
 
   return result;
 }
 
 void print_summary_table(const ResultsMap &results) {
+  bool timed = false;
+  bool counted = false;
+  for (const auto &type_pair : results) {
+    for (const auto &res_pair : type_pair.second) {
+      timed = timed || res_pair.second.timing.repetitions > 0;
+      counted = counted || res_pair.second.counters.available;
+    }
+  }
+  const int width = 74 + (timed ? 5 * 12 : 0) + (counted ? 5 * 14 : 0);
+  auto print_counter = [](const std::optional<unsigned long long> &value) {
+    if (value) {
+      std::cout << std::setw(14) << *value;
+    } else {
+      std::cout << std::setw(14) << "n/a";
+    }
+  };
 
   std::cout << std::left << std::setw(18) << "Test Case" << std::setw(10)
             << "Size" << std::setw(10) << "Result" << std::setw(18)
-            << "Comparisons" << std::setw(18) << "Data Moves" << std::endl;
-  std::cout << std::string(74, '-') << std::endl;
+            << "Comparisons" << std::setw(18) << "Data Moves";
+  if (timed) {
+    std::cout << std::setw(12) << "Min (us)" << std::setw(12) << "Median (us)"
+              << std::setw(12) << "p90 (us)" << std::setw(12) << "p99 (us)"
+              << std::setw(12) << "ns/elem";
+  }
+  if (counted) {
+    std::cout << std::setw(14) << "Instructions" << std::setw(14) << "Cycles"
+              << std::setw(14) << "Branch Miss" << std::setw(14) << "L1d Miss"
+              << std::setw(14) << "LLC Miss";
+  }
+  std::cout << std::endl;
+  std::cout << std::string(width, '-') << std::endl;
 
   const bool is_tty = testing_utils::is_stdout_a_tty();
 
@@ -139,6 +321,23 @@ void print_summary_table(const ResultsMap &results) {
                 << result.snapshot.total_comparisons() << std::setw(18)
                 << result.snapshot.total_data_moves();
 
+      if (timed) {
+        const TimingStats &timing = result.timing;
+        std::cout << std::fixed << std::setprecision(1) << std::setw(12)
+                  << timing.min_ns / 1e3 << std::setw(12)
+                  << timing.median_ns / 1e3 << std::setw(12)
+                  << timing.p90_ns / 1e3 << std::setw(12)
+                  << timing.p99_ns / 1e3 << std::setw(12)
+                  << timing.ns_per_element() << std::defaultfloat;
+      }
+      if (counted) {
+        print_counter(result.counters.instructions);
+        print_counter(result.counters.cycles);
+        print_counter(result.counters.branch_misses);
+        print_counter(result.counters.l1d_misses);
+        print_counter(result.counters.llc_misses);
+      }
+
       if (is_tty) {
         std::cout << RESET;
       }
@@ -149,26 +348,262 @@ void print_summary_table(const ResultsMap &results) {
     }
   }
 
-  std::cout << std::string(74, '-') << std::endl;
+  std::cout << std::string(width, '-') << std::endl;
+}
+
+// Runs McIlroy's adversary against funcptr at every size and prints how many
+// comparisons the constructed inputs cost, next to n log2 n and n^2 / 4 for
+// scale. Returns the largest replayed count found, 0 for a sort that makes
+// no comparisons.
+unsigned long long report_adversary(const SortingFunction &funcptr,
+                                    const TestOptions &options) {
+  print_colored_line("--- McIlroy Killer Adversary ---", BOLD_CYAN);
+  std::cout << std::left << std::setw(10) << "Size" << std::setw(18)
+            << "Adversary Cmp" << std::setw(18) << "Replayed Cmp"
+            << std::setw(14) << "n log2 n" << std::setw(14) << "n^2 / 4"
+            << std::setw(10) << "Result" << std::endl;
+  std::cout << std::string(84, '-') << std::endl;
+
+  unsigned long long worst = 0;
+  int worst_size = 0;
+  for (int size : options.sizes) {
+    if (size <= 0)
+      continue;
+    testing_adversary::AdversaryResult result =
+        testing_adversary::find_worst_case(funcptr, size);
+    if (result.replay_comparisons > worst) {
+      worst = result.replay_comparisons;
+      worst_size = size;
+    }
+    std::cout << std::left << std::setw(10) << size << std::setw(18)
+              << result.adversary_comparisons << std::setw(18)
+              << result.replay_comparisons << std::setw(14)
+              << (unsigned long long)(size * std::log2(double(size)))
+              << std::setw(14) << (unsigned long long)size * size / 4;
+    if (result.replay_sorted) {
+      print_colored_line("Passed", BOLD_GREEN);
+    } else {
+      print_colored_line("FAILED", BOLD_RED);
+    }
+  }
+  std::cout << std::string(84, '-') << std::endl;
+  if (worst_size == 0) {
+    // E.g. counting sort: nothing for the adversary to steer.
+    std::cout << "No comparisons observed, the sort does not compare elements"
+              << std::endl;
+  } else {
+    std::cout << "Worst comparison count found: " << worst << " (Size: "
+              << worst_size << ")" << std::endl;
+  }
+  return worst;
+}
+
+namespace {
+// test_sort_func_single_case, except that an exception thrown by the sort
+// fails the case and is written to out instead of ending the run. Returns
+// false when that happened, in which case nothing was measured.
+bool test_sort_func_guarded_case(const ArrayFiller &filler, Testing buffer[],
+                                 int size, const std::string &test_name,
+                                 const SortingFunction &funcptr,
+                                 const TestOptions &options, std::ostream &out,
+                                 bool parallel, bool measure,
+                                 SortingResult &result) {
+  try {
+    result = test_sort_func_single_case(filler, buffer, size, test_name,
+                                        funcptr, options, out, parallel,
+                                        measure);
+    return true;
+  } catch (const std::exception &e) {
+    result = SortingResult();
+    result.test_case_name = test_name;
+    result.array_size = size;
+    result.sorted = false;
+    print_colored(out, "  Exception: ", BOLD_RED);
+    out << e.what() << std::endl;
+    return false;
+  }
+}
+
+// One cell of an algorithm's distribution x size matrix. Its report goes to
+// log and is printed once every case has run, in matrix order.
+struct CaseJob {
+  const SortingFunction *funcptr;
+  const TestOptions *options;
+  const std::string *test_name;
+  const ArrayFiller *filler;
+  int size;
+  bool deferred = false; // measure_case still to run
+  SortingResult result;
+  std::ostringstream log;
+};
+
+void add_case_jobs(
+    std::vector<std::unique_ptr<CaseJob>> &jobs,
+    const std::vector<std::pair<std::string, ArrayFiller>> &test_generators,
+    const TestOptions &options, const SortingFunction &funcptr) {
+  for (const auto &test_pair : test_generators) {
+    for (int size : options.sizes) {
+      if (size < 0)
+        continue;
+      std::unique_ptr<CaseJob> job(new CaseJob);
+      job->funcptr = &funcptr;
+      job->options = &options;
+      job->test_name = &test_pair.first;
+      job->filler = &test_pair.second;
+      job->size = size;
+      jobs.push_back(std::move(job));
+    }
+  }
+}
+
+// Runs jobs on threads threads, the calling thread included. Each worker
+// takes the next unclaimed job and has its own input buffer. Cases that want
+// timing or hardware counters are measured afterwards, one at a time, when
+// serialize_timed_cases is set.
+void run_case_jobs(std::vector<std::unique_ptr<CaseJob>> &jobs, int threads) {
+  int max_size = 1;
+  for (const auto &job : jobs) {
+    max_size = std::max(max_size, job->size);
+  }
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    std::unique_ptr<Testing[]> buffer(new Testing[max_size]);
+    for (size_t i = next++; i < jobs.size(); i = next++) {
+      CaseJob &job = *jobs[i];
+      const TestOptions &options = *job.options;
+      job.deferred = options.serialize_timed_cases &&
+                     (options.timing || options.hardware_counters);
+      if (!test_sort_func_guarded_case(*job.filler, buffer.get(), job.size,
+                                       *job.test_name, *job.funcptr, options,
+                                       job.log, true, !job.deferred,
+                                       job.result)) {
+        job.deferred = false;
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; t++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+
+  std::unique_ptr<Testing[]> input(new Testing[max_size]);
+  for (const auto &job : jobs) {
+    if (!job->deferred || job->size <= 0)
+      continue;
+    testing_functions::Random rng(testing_functions::case_seed(
+        job->options->seed, *job->test_name, job->size));
+    (*job->filler)(input.get(), job->size, rng);
+    measure_case(input.get(), job->size, *job->funcptr, *job->options,
+                 job->result, job->log);
+  }
 }
 
+// Prints the logs of jobs[begin, end), which must be the cases of one
+// algorithm, and collects their results the way the serial loop of
+// run_all_test_cases does.
+std::pair<ResultsMap, bool>
+collect_case_jobs(const std::vector<std::unique_ptr<CaseJob>> &jobs,
+                  size_t begin, size_t end) {
+  ResultsMap results_by_type;
+  bool overall_verification_passed = true;
+  for (size_t i = begin; i < end; i++) {
+    const CaseJob &job = *jobs[i];
+    std::cout << job.log.str();
+    results_by_type[*job.test_name].push_back({job.size, job.result});
+    if (!job.result.sorted) {
+      overall_verification_passed = false;
+    }
+  }
+  for (auto &type_pair : results_by_type) {
+    std::sort(type_pair.second.begin(), type_pair.second.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+  }
+  return {results_by_type, overall_verification_passed};
+}
+
+void print_algorithm_header(const std::string &name,
+                            const TestOptions &options) {
+  print_colored_line("--- Testing Algorithm: " + name + " (input seed " +
+                         std::to_string(options.seed) + ") ---",
+                     BOLD_CYAN);
+  if (options.hardware_counters) {
+    testing_perf::PerfCollector probe;
+    if (!probe.available()) {
+      print_colored_line("Hardware counters unavailable (" +
+                             probe.unavailable_reason() + ")",
+                         YELLOW);
+    }
+  }
+}
+
+AlgorithmRunStatus report_algorithm(const std::string &name,
+                                    const SortingFunction &funcptr,
+                                    const TestOptions &options,
+                                    const ResultsMap &results,
+                                    bool all_passed_verification) {
+  print_colored_line("\n--- Summary Table for: " + name + " (input seed " +
+                         std::to_string(options.seed) + ") ---",
+                     BOLD_CYAN);
+  print_summary_table(results);
+
+  testing_complexity::ComplexityEstimate estimate;
+  bool complexity_mismatch = testing_complexity::analyze_and_print_complexity(
+      results, options, &estimate);
+  testing_export::export_results(name, results, options, estimate);
+
+  if (options.adversary) {
+    report_adversary(funcptr, options);
+  }
+
+  print_colored_line("--- Finished Testing: " + name + " ---", BOLD_CYAN);
+
+  if (!all_passed_verification) {
+    return AlgorithmRunStatus::FAILED_VERIFICATION;
+  } else if (complexity_mismatch) {
+    return AlgorithmRunStatus::PASSED_COMPLEXITY_WARN;
+  } else {
+    return AlgorithmRunStatus::PASSED;
+  }
+}
+} // namespace
+
 std::pair<ResultsMap, bool> run_all_test_cases(
-    const std::vector<std::pair<std::string, ArrayGenerator>> &test_generators,
+    const std::vector<std::pair<std::string, ArrayFiller>> &test_generators,
     const TestOptions &options, const SortingFunction &funcptr) {
+  if (options.threads > 1) {
+    std::vector<std::unique_ptr<CaseJob>> jobs;
+    add_case_jobs(jobs, test_generators, options, funcptr);
+    run_case_jobs(jobs, options.threads);
+    return collect_case_jobs(jobs, 0, jobs.size());
+  }
+
   ResultsMap results_by_type;
   bool overall_verification_passed = true;
 
+  // One input buffer, big enough for the largest size, shared by all cases.
+  int max_size = 0;
+  for (int size : options.sizes) {
+    max_size = std::max(max_size, size);
+  }
+  std::unique_ptr<Testing[]> buffer(new Testing[std::max(1, max_size)]);
+
   for (const auto &test_pair : test_generators) {
     const std::string &test_name = test_pair.first;
-    const ArrayGenerator &generator = test_pair.second;
+    const ArrayFiller &filler = test_pair.second;
     results_by_type[test_name] = {};
 
     for (int size : options.sizes) {
       if (size < 0)
         continue;
 
-      SortingResult result = test_sort_func_single_case(
-          generator, size, test_name, funcptr, options);
+      SortingResult result;
+      test_sort_func_guarded_case(filler, buffer.get(), size, test_name,
+                                  funcptr, options, std::cout, false, true,
+                                  result);
       results_by_type[test_name].push_back({size, result});
 
       if (!result.sorted) {
@@ -185,33 +620,13 @@ std::pair<ResultsMap, bool> run_all_test_cases(
 AlgorithmRunStatus testing_sort_func(std::string name,
                                      const SortingFunction &funcptr,
                                      const TestOptions &options) {
-  print_colored_line("--- Testing Algorithm: " + name + " ---", BOLD_CYAN);
-
-  std::vector<std::pair<std::string, ArrayGenerator>> test_generators = {
-      {"Reversed", testing_functions::reversed},
-      {"Sorted", testing_functions::sorted},
-      {"Random Unique", testing_functions::random_unique},
-      {"Few Unique", testing_functions::few_unique},
-      {"Nearly Sorted", testing_functions::nearly_sorted}};
-
-  auto [results, all_passed_verification] =
-      run_all_test_cases(test_generators, options, funcptr);
+  print_algorithm_header(name, options);
 
-  print_colored_line("\n--- Summary Table for: " + name + " ---", BOLD_CYAN);
-  print_summary_table(results);
-
-  bool complexity_mismatch =
-      testing_complexity::analyze_and_print_complexity(results, options);
+  auto [results, all_passed_verification] = run_all_test_cases(
+      testing_functions::distributions(), options, funcptr);
 
-  print_colored_line("--- Finished Testing: " + name + " ---", BOLD_CYAN);
-
-  if (!all_passed_verification) {
-    return AlgorithmRunStatus::FAILED_VERIFICATION;
-  } else if (complexity_mismatch) {
-    return AlgorithmRunStatus::PASSED_COMPLEXITY_WARN;
-  } else {
-    return AlgorithmRunStatus::PASSED;
-  }
+  return report_algorithm(name, funcptr, options, results,
+                          all_passed_verification);
 }
 
 int test_all_algorithms(
@@ -222,12 +637,42 @@ int test_all_algorithms(
   std::map<std::string, AlgorithmRunStatus> results;
   bool any_warnings_or_failures = false;
 
-  for (const auto &config : algorithms_to_test) {
-    AlgorithmRunStatus status =
-        testing_sort_func(config.name, config.funcptr, config.options);
+  // The cases of every algorithm with the same options.threads above 1 share
+  // one pool, which runs them before any report is printed; the reports
+  // then follow in the usual order. Algorithms with threads = 1 run serially
+  // on this thread when their turn comes.
+  std::map<int, std::vector<std::unique_ptr<CaseJob>>> pools;
+  std::vector<std::pair<size_t, size_t>> job_range(algorithms_to_test.size());
+  for (size_t i = 0; i < algorithms_to_test.size(); i++) {
+    const AlgorithmTestConfig &config = algorithms_to_test[i];
+    if (config.options.threads > 1) {
+      auto &jobs = pools[config.options.threads];
+      job_range[i].first = jobs.size();
+      add_case_jobs(jobs, testing_functions::distributions(), config.options,
+                    config.funcptr);
+      job_range[i].second = jobs.size();
+    }
+  }
+  for (auto &pool : pools) {
+    run_case_jobs(pool.second, pool.first);
+  }
+
+  for (size_t i = 0; i < algorithms_to_test.size(); i++) {
+    const AlgorithmTestConfig &config = algorithms_to_test[i];
+    AlgorithmRunStatus status;
+    if (config.options.threads > 1) {
+      print_algorithm_header(config.name, config.options);
+      auto [case_results, all_passed_verification] =
+          collect_case_jobs(pools[config.options.threads], job_range[i].first,
+                            job_range[i].second);
+      status = report_algorithm(config.name, config.funcptr, config.options,
+                                case_results, all_passed_verification);
+    } else {
+      status = testing_sort_func(config.name, config.funcptr, config.options);
+    }
     results[config.name] = status;
 
-    any_warnings_or_failures &= status != AlgorithmRunStatus::PASSED;
+    any_warnings_or_failures |= status != AlgorithmRunStatus::PASSED;
     std::cout << "\n----------------------------------------\n" << std::endl;
   }
 
@@ -14,7 +14,9 @@ using testing_framework::TestOptions;
 PRELUDE;
 struct AlgorithmTestConfig {
   std::string name;
-  const SortingFunction &funcptr;
+  // By value: configs are brace-initialised from function templates and
+  // lambdas, so a reference would bind to a temporary std::function.
+  SortingFunction funcptr;
   TestOptions options = {};
 };
 
@@ -45,50 +45,78 @@ inline bool is_stdout_a_tty() {
 }
 
 // --- Printing Functions (Definitions in Header) ---
+// The os overloads let the harness buffer a case's output and print it
+// later; the rest print to std::cout. Colors follow whether stdout is a
+// terminal, since that is where buffered output ends up as well.
 
-inline void print_colored(const std::string &text, const char *color_code) {
+inline void print_colored(std::ostream &os, const std::string &text,
+                          const char *color_code) {
   if (is_stdout_a_tty() && color_code != RESET &&
       color_code[0] != '\0') { // Added check for non-reset/empty color
-    std::cout << color_code << text << RESET;
+    os << color_code << text << RESET;
   } else {
-    std::cout << text;
+    os << text;
   }
 }
 
+inline void print_colored(const std::string &text, const char *color_code) {
+  print_colored(std::cout, text, color_code);
+}
+
 inline void print_colored(const char *text, const char *color_code) {
-  if (is_stdout_a_tty() && color_code != RESET && color_code[0] != '\0') {
-    std::cout << color_code << text << RESET;
-  } else {
-    std::cout << text;
-  }
+  print_colored(std::cout, std::string(text), color_code);
+}
+
+inline void print_colored_line(std::ostream &os, const std::string &text,
+                               const char *color_code) {
+  print_colored(os, text, color_code);
+  os << std::endl;
 }
 
 inline void print_colored_line(const std::string &text,
                                const char *color_code) {
-  if (is_stdout_a_tty() && color_code != RESET && color_code[0] != '\0') {
-    std::cout << color_code << text << RESET << std::endl;
-  } else {
-    std::cout << text << std::endl;
-  }
+  print_colored_line(std::cout, text, color_code);
 }
 
 // Make sure the parameter order matches the declaration if split
 inline void print_colored_line(const char *text, const char *color_code) {
-  if (is_stdout_a_tty() && color_code != RESET && color_code[0] != '\0') {
-    std::cout << color_code << text << RESET << std::endl;
-  } else {
-    std::cout << text << std::endl;
-  }
+  print_colored_line(std::cout, std::string(text), color_code);
 }
 
 // --- printArray Template (Already correctly defined in header) ---
 template <typename T>
-void printArray(const T *arr, int nrOfElements) { // Made arr const T*
-  std::cout << "["; // Removed extra space for consistency maybe?
+void printArray(std::ostream &os, const T *arr, int nrOfElements) {
+  os << "["; // Removed extra space for consistency maybe?
   for (int i = 0; i < nrOfElements; i++) {
-    std::cout << arr[i] << (i == nrOfElements - 1 ? "" : ", ");
+    os << arr[i] << (i == nrOfElements - 1 ? "" : ", ");
+  }
+  os << "]" << std::endl;
+}
+
+// Like printArray, but past limit elements only the first and last
+// limit / 2 are printed, so logging a huge array stays cheap.
+template <typename T>
+void printArrayBounded(std::ostream &os, const T *arr, int nrOfElements,
+                       int limit) {
+  if (nrOfElements <= limit) {
+    printArray(os, arr, nrOfElements);
+    return;
   }
-  std::cout << "]" << std::endl;
+  int half = limit / 2;
+  os << "[";
+  for (int i = 0; i < half; i++) {
+    os << arr[i] << ", ";
+  }
+  os << "... " << nrOfElements - 2 * half << " more ...";
+  for (int i = nrOfElements - half; i < nrOfElements; i++) {
+    os << ", " << arr[i];
+  }
+  os << "]" << std::endl;
+}
+
+template <typename T>
+void printArray(const T *arr, int nrOfElements) { // Made arr const T*
+  printArray(std::cout, arr, nrOfElements);
 }
 
 } // namespace testing
@@ -0,0 +1,130 @@
+#ifndef COLUMNARSORT_H
+#define COLUMNARSORT_H
+#include "a2.h"
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Multi-column sort for tables stored as separate column arrays. The key
+// columns produce a row permutation, which is then applied to whichever
+// columns the caller wants reordered, so rows never exist as structs.
+//
+// Keys are mapped to unsigned integers whose order matches the column order
+// ("normalized keys"). If all key columns fit in 64 bits together they are
+// packed into one key and radix sorted once; otherwise the rows are radix
+// sorted column by column from the last key to the first, which is stable and
+// therefore lexicographic. Floating point keys follow IEEE 754 totalOrder:
+// -0.0 sorts before +0.0 and NaNs (sign bit clear) after +infinity.
+
+enum class SortOrder { Ascending, Descending };
+
+template <class T> struct KeyColumn {
+  const T *data;
+  SortOrder order = SortOrder::Ascending;
+};
+
+template <class T> struct NormalizedKeyType {
+  static_assert(std::is_arithmetic<T>::value,
+                "Key columns must hold integral or floating point values");
+  static_assert(!std::is_same<typename std::remove_cv<T>::type,
+                              long double>::value,
+                "long double keys have no unsigned type of the same width");
+  using type = typename std::conditional<
+      sizeof(T) == 1, unsigned char,
+      typename std::conditional<
+          sizeof(T) == 2, unsigned short,
+          typename std::conditional<sizeof(T) == 4, unsigned int,
+                                    unsigned long long>::type>::type>::type;
+};
+
+template <class T>
+typename NormalizedKeyType<T>::type NormalizeKey(T value, SortOrder order) {
+  using U = typename NormalizedKeyType<T>::type;
+  const U sign_bit = U(U(1) << (sizeof(U) * 8 - 1));
+  U key;
+  if constexpr (std::is_floating_point<T>::value) {
+    // Negative floats order backwards by bit pattern, so flip all their bits;
+    // positive ones only need the sign bit set to sort above them.
+    std::memcpy(&key, &value, sizeof(U));
+    key = (key & sign_bit) ? U(~key) : U(key | sign_bit);
+  } else if constexpr (std::is_signed<T>::value) {
+    key = U(U(value) ^ sign_bit);
+  } else {
+    key = U(value);
+  }
+  return order == SortOrder::Descending ? U(~key) : key;
+}
+
+struct PackedRowKey {
+  unsigned long long key;
+  int row;
+};
+
+template <class T>
+void PackKeyColumn(unsigned long long &packed, const KeyColumn<T> &column,
+                   int row) {
+  const int bits = int(sizeof(T) * 8);
+  packed = bits == 64 ? 0 : packed << bits;
+  packed |= NormalizeKey(column.data[row], column.order);
+}
+
+template <class T, class... Rest>
+void SortRowsByKeyColumns(int rows[], int nrOfRows, const KeyColumn<T> &first,
+                          const KeyColumn<Rest> &...rest) {
+  if constexpr (sizeof...(Rest) > 0) {
+    SortRowsByKeyColumns(rows, nrOfRows, rest...);
+  }
+  RadixSortByKey(rows, nrOfRows, [&first](int row) {
+    return NormalizeKey(first.data[row], first.order);
+  });
+}
+
+// Returns the row order that sorts the table by the key columns, first column
+// most significant. Ties keep their original row order.
+template <class... Ts>
+std::vector<int> ColumnarSortPermutation(int nrOfRows,
+                                         const KeyColumn<Ts> &...keys) {
+  static_assert(sizeof...(Ts) > 0, "At least one key column is needed");
+  std::vector<int> permutation(std::max(nrOfRows, 0));
+  if constexpr ((sizeof(Ts) + ...) <= sizeof(unsigned long long)) {
+    std::vector<PackedRowKey> packed(permutation.size());
+    for (int row = 0; row < nrOfRows; row++) {
+      packed[row].key = 0;
+      packed[row].row = row;
+      (PackKeyColumn(packed[row].key, keys, row), ...);
+    }
+    RadixSortByKey(packed.data(), nrOfRows,
+                   [](const PackedRowKey &p) { return p.key; });
+    for (int i = 0; i < nrOfRows; i++) {
+      permutation[i] = packed[i].row;
+    }
+  } else {
+    for (int row = 0; row < nrOfRows; row++) {
+      permutation[row] = row;
+    }
+    SortRowsByKeyColumns(permutation.data(), nrOfRows, keys...);
+  }
+  return permutation;
+}
+
+// Reorders one column so that column[i] becomes the old column[permutation[i]].
+template <class T>
+void GatherColumn(T column[], const std::vector<int> &permutation) {
+  int nrOfRows = int(permutation.size());
+  T *buffer = new T[nrOfRows];
+  for (int i = 0; i < nrOfRows; i++) {
+    buffer[i] = std::move(column[permutation[i]]);
+  }
+  for (int i = 0; i < nrOfRows; i++) {
+    column[i] = std::move(buffer[i]);
+  }
+  delete[] buffer;
+}
+
+template <class... Ts>
+void GatherColumns(const std::vector<int> &permutation, Ts *...columns) {
+  (GatherColumn(columns, permutation), ...);
+}
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef SEGMENTEDSORT_H
+#define SEGMENTEDSORT_H
+#include "SortingNetwork.h"
+#include "a2.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Sorts many small independent segments stored back to back in one buffer.
+// Segment s is values[offsets[s], offsets[s + 1]), so offsets holds
+// nrOfSegments + 1 entries. Each segment is sorted by a kernel picked from its
+// size and the segments are split across threads by element count.
+
+const int SegmentedSortInsertionLimit = 32;
+const int SegmentedSortParallelThreshold = 1 << 15; // Elements per thread
+
+template <class T> void SortSegment(T elements[], int nrOfElements) {
+  switch (nrOfElements) {
+  case 0:
+  case 1:
+    return;
+  case 2:
+    return NetworkSort<2>(elements);
+  case 3:
+    return NetworkSort<3>(elements);
+  case 4:
+    return NetworkSort<4>(elements);
+  case 5:
+    return NetworkSort<5>(elements);
+  case 6:
+    return NetworkSort<6>(elements);
+  case 7:
+    return NetworkSort<7>(elements);
+  case 8:
+    return NetworkSort<8>(elements);
+  case 9:
+    return NetworkSort<9>(elements);
+  case 10:
+    return NetworkSort<10>(elements);
+  case 11:
+    return NetworkSort<11>(elements);
+  case 12:
+    return NetworkSort<12>(elements);
+  case 13:
+    return NetworkSort<13>(elements);
+  case 14:
+    return NetworkSort<14>(elements);
+  case 15:
+    return NetworkSort<15>(elements);
+  case 16:
+    return NetworkSort<16>(elements);
+  }
+  if (nrOfElements <= SegmentedSortInsertionLimit) {
+    InsertionsortRange(elements, 0, nrOfElements - 1);
+  } else {
+    Introsort(elements, nrOfElements);
+  }
+}
+
+template <class T>
+void SortSegmentRange(T values[], const int offsets[], int first_segment,
+                      int last_segment) {
+  for (int s = first_segment; s < last_segment; s++) {
+    SortSegment(values + offsets[s], offsets[s + 1] - offsets[s]);
+  }
+}
+
+// nrOfThreads = 0 uses one thread per hardware thread. Small inputs are sorted
+// on the calling thread since starting threads would cost more than the sort.
+template <class T>
+void SegmentedSort(T values[], const int offsets[], int nrOfSegments,
+                   int nrOfThreads = 0) {
+  if (nrOfSegments <= 0) {
+    return;
+  }
+  int total = offsets[nrOfSegments] - offsets[0];
+  if (nrOfThreads <= 0) {
+    nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  nrOfThreads = std::min(nrOfThreads,
+                         std::max(1, total / SegmentedSortParallelThreshold));
+  nrOfThreads = std::min(nrOfThreads, nrOfSegments);
+  if (nrOfThreads <= 1) {
+    SortSegmentRange(values, offsets, 0, nrOfSegments);
+    return;
+  }
+
+  // Cut the segment list where the running element count crosses each
+  // thread's share, so one huge segment does not stall an even split.
+  std::vector<int> bounds = {0};
+  for (int t = 1; t < nrOfThreads; t++) {
+    int target = offsets[0] + int((long long)total * t / nrOfThreads);
+    int cut = int(std::lower_bound(offsets + bounds.back(),
+                                   offsets + nrOfSegments, target) -
+                  offsets);
+    bounds.push_back(std::max(cut, bounds.back()));
+  }
+  bounds.push_back(nrOfSegments);
+
+  std::vector<std::thread> workers;
+  for (int t = 1; t < nrOfThreads; t++) {
+    workers.emplace_back(SortSegmentRange<T>, values, offsets, bounds[t],
+                         bounds[t + 1]);
+  }
+  SortSegmentRange(values, offsets, bounds[0], bounds[1]);
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+#endif
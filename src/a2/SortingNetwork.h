@@ -0,0 +1,128 @@
+#ifndef SORTINGNETWORK_H
+#define SORTINGNETWORK_H
+#include <array>
+#include <cstddef>
+#include <utility>
+
+// Fixed size sorting networks. The comparator list for N is built at compile
+// time and unrolled into straight-line compare-exchanges, so sorting a
+// std::array<T, N> has no loops and no data dependent branches for types whose
+// compare-exchange lowers to min/max (cmov).
+
+struct Comparator {
+  int i;
+  int j;
+};
+
+template <class T> constexpr void CompareExchange(T &a, T &b) {
+  const bool out_of_order = b < a;
+  const T low = out_of_order ? b : a;
+  const T high = out_of_order ? a : b;
+  a = low;
+  b = high;
+}
+
+// Batcher's odd-even mergesort for arbitrary N. Optimal for N <= 4 and N = 8,
+// within a few comparators of the best known networks elsewhere.
+template <int N> constexpr int BatcherNetworkSize() {
+  int count = 0;
+  for (int p = 1; p < N; p <<= 1) {
+    for (int k = p; k >= 1; k >>= 1) {
+      for (int j = k % p; j + k < N; j += 2 * k) {
+        for (int i = 0; i < k && i < N - j - k; i++) {
+          if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+            count++;
+          }
+        }
+      }
+    }
+  }
+  return count;
+}
+
+template <int N>
+constexpr std::array<Comparator, BatcherNetworkSize<N>()> BatcherNetwork() {
+  std::array<Comparator, BatcherNetworkSize<N>()> network{};
+  int count = 0;
+  for (int p = 1; p < N; p <<= 1) {
+    for (int k = p; k >= 1; k >>= 1) {
+      for (int j = k % p; j + k < N; j += 2 * k) {
+        for (int i = 0; i < k && i < N - j - k; i++) {
+          if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+            network[count] = Comparator{i + j, i + j + k};
+            count++;
+          }
+        }
+      }
+    }
+  }
+  return network;
+}
+
+template <int N> struct SortingNetwork {
+  static constexpr auto comparators = BatcherNetwork<N>();
+};
+
+// Best known (size optimal) networks where Batcher is not already optimal.
+template <> struct SortingNetwork<5> {
+  static constexpr std::array<Comparator, 9> comparators = {{
+      {0, 3}, {1, 4}, {0, 2}, {1, 3}, {0, 1}, {2, 4}, {1, 2}, {3, 4}, {2, 3},
+  }};
+};
+
+template <> struct SortingNetwork<6> {
+  static constexpr std::array<Comparator, 12> comparators = {{
+      {0, 5}, {1, 3}, {2, 4}, {1, 2}, {3, 4}, {0, 3},
+      {2, 5}, {0, 1}, {2, 3}, {4, 5}, {1, 2}, {3, 4},
+  }};
+};
+
+template <> struct SortingNetwork<7> {
+  static constexpr std::array<Comparator, 16> comparators = {{
+      {0, 6}, {2, 3}, {4, 5}, {0, 2}, {1, 4}, {3, 6}, {0, 1}, {2, 5},
+      {3, 4}, {1, 2}, {4, 6}, {2, 3}, {4, 5}, {1, 2}, {3, 4}, {5, 6},
+  }};
+};
+
+template <> struct SortingNetwork<16> {
+  static constexpr std::array<Comparator, 60> comparators = {{
+      {0, 13}, {1, 12}, {2, 15}, {3, 14}, {4, 8},   {5, 6},   {7, 11},
+      {9, 10}, {0, 5},  {1, 7},  {2, 9},  {3, 4},   {6, 13},  {8, 14},
+      {10, 15}, {11, 12}, {0, 1}, {2, 3},  {4, 5},   {6, 8},   {7, 9},
+      {10, 11}, {12, 13}, {14, 15}, {0, 2}, {1, 3},  {4, 10},  {5, 11},
+      {6, 7},  {8, 9},  {12, 14}, {13, 15}, {1, 2},  {3, 12},  {4, 6},
+      {5, 7},  {8, 10}, {9, 11}, {13, 14}, {1, 4},   {2, 6},   {5, 8},
+      {7, 10}, {9, 13}, {11, 14}, {2, 4},  {3, 6},   {9, 12},  {11, 13},
+      {3, 5},  {6, 8},  {7, 9},  {10, 12}, {3, 4},   {5, 6},   {7, 8},
+      {9, 10}, {11, 12}, {6, 7}, {8, 9},
+  }};
+};
+
+template <int N, class T, std::size_t... I>
+constexpr void ApplySortingNetwork(T *elements, std::index_sequence<I...>) {
+  constexpr auto &network = SortingNetwork<N>::comparators;
+  (CompareExchange(elements[network[I].i], elements[network[I].j]), ...);
+}
+
+// Sorts exactly N elements starting at elements.
+template <int N, class T> constexpr void NetworkSort(T *elements) {
+  if constexpr (N > 1) {
+    ApplySortingNetwork<N>(
+        elements,
+        std::make_index_sequence<SortingNetwork<N>::comparators.size()>{});
+  }
+}
+
+template <class T, std::size_t N>
+constexpr void NetworkSort(std::array<T, N> &elements) {
+  NetworkSort<int(N)>(elements.data());
+}
+
+// Value returning form for use in constant expressions.
+template <class T, std::size_t N>
+constexpr std::array<T, N> NetworkSorted(std::array<T, N> elements) {
+  NetworkSort(elements);
+  return elements;
+}
+
+#endif
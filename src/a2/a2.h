@@ -2,6 +2,7 @@
 #define A2_HPP
 #include <algorithm>
 #include <iostream>
+#include <type_traits>
 #define swp(i, j) std::swap(elements[i], elements[j]);
 
 template <typename T> void printArray2(T *arr, int nrOfElements) {
@@ -250,7 +251,7 @@ template <class T>
 void QuicksortHoareImprovedMedian3Recursive(T elements[], int start, int end) {
   if (start < end) {
     int pivot = PartitionHoareImprovedMedainOf3(elements, start, end);
-    QuicksortHoareImprovedMedian3Recursive(elements, start, pivot);
+    QuicksortHoareImprovedMedian3Recursive(elements, start, pivot - 1);
     QuicksortHoareImprovedMedian3Recursive(elements, pivot + 1, end);
   }
 }
@@ -294,4 +295,489 @@ template <class T> void Heapsort(T elements[], int nrOfElements) {
   }
 }
 
+template <class T>
+void InsertionsortRange(T elements[], int start, int end) {
+  for (int i = start + 1; i <= end; i++) {
+    T key = elements[i];
+    int j = i - 1;
+    while (j >= start && key < elements[j]) {
+      elements[j + 1] = elements[j];
+      j--;
+    }
+    elements[j + 1] = key;
+  }
+}
+
+// Median of three with the median moved to start, then a Hoare partition that
+// only uses operator<. Returns the last index of the left part.
+template <class T> int PartitionIntro(T elements[], int start, int end) {
+  int pivot = MedianOfThree(elements, start, end);
+  swp(start, pivot);
+  T pivot_value = elements[start];
+  int i = start - 1;
+  int j = end + 1;
+  while (true) {
+    do {
+      i++;
+    } while (elements[i] < pivot_value);
+    do {
+      j--;
+    } while (pivot_value < elements[j]);
+    if (i >= j) {
+      return j;
+    }
+    swp(i, j);
+  }
+}
+
+template <class T>
+void IntrosortRecursive(T elements[], int start, int end, int depth_limit) {
+  while (end - start > 16) {
+    if (depth_limit == 0) {
+      Heapsort(elements + start, end - start + 1);
+      return;
+    }
+    depth_limit--;
+    int pivot = PartitionIntro(elements, start, end);
+    // Recurse into the smaller half so the stack stays O(log n).
+    if (pivot - start < end - pivot) {
+      IntrosortRecursive(elements, start, pivot, depth_limit);
+      start = pivot + 1;
+    } else {
+      IntrosortRecursive(elements, pivot + 1, end, depth_limit);
+      end = pivot;
+    }
+  }
+  InsertionsortRange(elements, start, end);
+}
+
+template <class T> void Introsort(T elements[], int nrOfElements) {
+  if (nrOfElements <= 1) {
+    return;
+  }
+  int depth_limit = 0;
+  for (int n = nrOfElements; n > 1; n >>= 1) {
+    depth_limit += 2;
+  }
+  IntrosortRecursive(elements, 0, nrOfElements - 1, depth_limit);
+}
+
+// Dijkstra style three way partition: [start, lt) < pivot, [lt, gt] == pivot,
+// (gt, end] > pivot. Equal keys are never looked at again.
+template <class T>
+void QuicksortThreeWayRecursive(T elements[], int start, int end) {
+  while (end - start > 16) {
+    int pivot = MedianOfThree(elements, start, end);
+    swp(start, pivot);
+    T pivot_value = elements[start];
+    int lt = start;
+    int gt = end;
+    int i = start + 1;
+    while (i <= gt) {
+      if (elements[i] < pivot_value) {
+        swp(lt, i);
+        lt++;
+        i++;
+      } else if (pivot_value < elements[i]) {
+        swp(i, gt);
+        gt--;
+      } else {
+        i++;
+      }
+    }
+    if (lt - start < end - gt) {
+      QuicksortThreeWayRecursive(elements, start, lt - 1);
+      start = gt + 1;
+    } else {
+      QuicksortThreeWayRecursive(elements, gt + 1, end);
+      end = lt - 1;
+    }
+  }
+  InsertionsortRange(elements, start, end);
+}
+
+template <class T> void QuicksortThreeWay(T elements[], int nrOfElements) {
+  if (nrOfElements > 1) {
+    QuicksortThreeWayRecursive(elements, 0, nrOfElements - 1);
+  }
+}
+
+// Merges the sorted runs [start, mid) and [mid, end), buffering only the left
+// run. Stable: an element from the right run only wins if it is strictly less.
+template <class T>
+void MergeRuns(T elements[], T buffer[], int start, int mid, int end) {
+  int leftNrOfElements = mid - start;
+  for (int i = 0; i < leftNrOfElements; i++) {
+    buffer[i] = elements[start + i];
+  }
+  int i = 0, j = mid, k = start;
+  while (i < leftNrOfElements && j < end) {
+    if (elements[j] < buffer[i]) {
+      elements[k] = elements[j];
+      ++j;
+    } else {
+      elements[k] = buffer[i];
+      ++i;
+    }
+    ++k;
+  }
+  while (i < leftNrOfElements) {
+    elements[k] = buffer[i];
+    ++i;
+    ++k;
+  }
+}
+
+// Natural mergesort: strictly descending runs are reversed in place, then the
+// runs are merged pairwise until one is left. O(n log runs).
+template <class T> void RunMergesort(T elements[], int nrOfElements) {
+  if (nrOfElements <= 1) {
+    return;
+  }
+  int *run_starts = new int[nrOfElements + 1];
+  int runs = 0;
+  int i = 0;
+  while (i < nrOfElements) {
+    run_starts[runs++] = i;
+    int j = i + 1;
+    if (j < nrOfElements && elements[j] < elements[i]) {
+      while (j + 1 < nrOfElements && elements[j + 1] < elements[j]) {
+        j++;
+      }
+      std::reverse(elements + i, elements + j + 1);
+      j++;
+    } else {
+      while (j < nrOfElements && !(elements[j] < elements[j - 1])) {
+        j++;
+      }
+    }
+    i = j;
+  }
+  run_starts[runs] = nrOfElements;
+
+  T *buffer = new T[nrOfElements];
+  int *merged = new int[nrOfElements + 1];
+  while (runs > 1) {
+    int merged_runs = 0;
+    for (int r = 0; r < runs; r += 2) {
+      merged[merged_runs++] = run_starts[r];
+      if (r + 1 < runs) {
+        MergeRuns(elements, buffer, run_starts[r], run_starts[r + 1],
+                  run_starts[r + 2]);
+      }
+    }
+    merged[merged_runs] = nrOfElements;
+    std::swap(run_starts, merged);
+    runs = merged_runs;
+  }
+  delete[] buffer;
+  delete[] merged;
+  delete[] run_starts;
+}
+
+// Stable LSD radix sort on the bytes of an integral key. Signed keys get their
+// sign bit flipped so the unsigned byte order matches the signed order.
+template <class T, class KeyFunction>
+void RadixSortByKey(T elements[], int nrOfElements, KeyFunction key) {
+  using K = typename std::decay<decltype(key(elements[0]))>::type;
+  static_assert(std::is_integral<K>::value,
+                "RadixSortByKey needs an integral key");
+  if (nrOfElements <= 1) {
+    return;
+  }
+  using U = typename std::make_unsigned<K>::type;
+  const U flip = std::is_signed<K>::value ? U(U(1) << (sizeof(K) * 8 - 1)) : 0;
+  T *buffer = new T[nrOfElements];
+  T *from = elements;
+  T *to = buffer;
+  for (unsigned shift = 0; shift < sizeof(K) * 8; shift += 8) {
+    int counts[257] = {0};
+    for (int i = 0; i < nrOfElements; i++) {
+      counts[((U(key(from[i])) ^ flip) >> shift & 0xFF) + 1]++;
+    }
+    if (counts[((U(key(from[0])) ^ flip) >> shift & 0xFF) + 1] ==
+        nrOfElements) {
+      continue; // Every element has the same byte here, nothing to move.
+    }
+    for (int b = 0; b < 256; b++) {
+      counts[b + 1] += counts[b];
+    }
+    for (int i = 0; i < nrOfElements; i++) {
+      to[counts[(U(key(from[i])) ^ flip) >> shift & 0xFF]++] = from[i];
+    }
+    std::swap(from, to);
+  }
+  if (from != elements) {
+    std::copy(from, from + nrOfElements, elements);
+  }
+  delete[] buffer;
+}
+
+template <class T> void RadixSort(T elements[], int nrOfElements) {
+  static_assert(std::is_integral<T>::value,
+                "RadixSort only works on integral types");
+  RadixSortByKey(elements, nrOfElements, [](const T &value) { return value; });
+}
+
+// --- Counting sort ---
+
+// Largest key range (max - min + 1) counting sort will allocate counters for.
+// Small inputs still get 64Ki counters so 16 bit bucket keys always qualify,
+// large ones may use up to 4 counters per element, capped at 16 MiB.
+inline long long CountingSortBudget(int nrOfElements) {
+  return std::min<long long>(std::max<long long>(1 << 16, 4LL * nrOfElements),
+                             1 << 22);
+}
+
+// Distance of key from min_key <= key, taken in the unsigned type of K so
+// keys on both sides of LLONG_MAX (or of 0) cannot wrap.
+template <class K>
+unsigned long long CountingSortOffset(K key, K min_key) {
+  using U = typename std::make_unsigned<typename std::conditional<
+      std::is_same<K, bool>::value, unsigned, K>::type>::type;
+  return (unsigned long long)U(U(key) - U(min_key));
+}
+
+// Key range of elements, or -1 if it does not fit in max_range counters.
+// Keys are compared in their own type K.
+template <class T, class KeyFunction, class K>
+long long CountingSortRange(T elements[], int nrOfElements, KeyFunction key,
+                            long long max_range, K &min_key) {
+  K low = key(elements[0]);
+  K high = low;
+  for (int i = 1; i < nrOfElements; i++) {
+    K k = key(elements[i]);
+    low = std::min(low, k);
+    high = std::max(high, k);
+  }
+  min_key = low;
+  unsigned long long range = CountingSortOffset(high, low) + 1;
+  if (range == 0 || range > (unsigned long long)max_range) {
+    return -1;
+  }
+  return (long long)range;
+}
+
+// Counting sort of plain integers: histogram the keys, then write each value
+// back as often as it was counted. Returns false without touching the array if
+// the key range exceeds max_range.
+template <class T>
+bool TryCountingSort(T elements[], int nrOfElements, long long max_range) {
+  static_assert(std::is_integral<T>::value,
+                "CountingSort only works on integral types");
+  if (nrOfElements <= 1) {
+    return true;
+  }
+  T min_key = T();
+  long long range = CountingSortRange(
+      elements, nrOfElements, [](const T &value) { return value; }, max_range,
+      min_key);
+  if (range < 0) {
+    return false;
+  }
+  int *counts = new int[range]();
+  for (int i = 0; i < nrOfElements; i++) {
+    counts[CountingSortOffset(elements[i], min_key)]++;
+  }
+  int k = 0;
+  for (long long offset = 0; offset < range; offset++) {
+    for (int c = counts[offset]; c > 0; c--) {
+      elements[k++] = T(min_key + offset); // At most the largest key
+    }
+  }
+  delete[] counts;
+  return true;
+}
+
+// Falls back to radix sort when the range is too wide for the budget.
+template <class T> void CountingSort(T elements[], int nrOfElements) {
+  if (!TryCountingSort(elements, nrOfElements,
+                       CountingSortBudget(nrOfElements))) {
+    RadixSort(elements, nrOfElements);
+  }
+}
+
+// Stable counting sort of records by an integral key extracted with key().
+template <class T, class KeyFunction>
+bool TryCountingSortByKey(T elements[], int nrOfElements, KeyFunction key,
+                          long long max_range) {
+  using K = typename std::decay<decltype(key(elements[0]))>::type;
+  static_assert(std::is_integral<K>::value,
+                "CountingSortByKey needs an integral key");
+  if (nrOfElements <= 1) {
+    return true;
+  }
+  K min_key = K();
+  long long range =
+      CountingSortRange(elements, nrOfElements, key, max_range, min_key);
+  if (range < 0) {
+    return false;
+  }
+  int *offsets = new int[range + 1]();
+  for (int i = 0; i < nrOfElements; i++) {
+    offsets[CountingSortOffset<K>(key(elements[i]), min_key) + 1]++;
+  }
+  for (long long b = 0; b < range; b++) {
+    offsets[b + 1] += offsets[b];
+  }
+  T *buffer = new T[nrOfElements];
+  for (int i = 0; i < nrOfElements; i++) {
+    buffer[offsets[CountingSortOffset<K>(key(elements[i]), min_key)]++] =
+        elements[i];
+  }
+  std::copy(buffer, buffer + nrOfElements, elements);
+  delete[] buffer;
+  delete[] offsets;
+  return true;
+}
+
+// Falls back to the (also stable) radix sort by key for wide ranges.
+template <class T, class KeyFunction>
+void CountingSortByKey(T elements[], int nrOfElements, KeyFunction key) {
+  if (!TryCountingSortByKey(elements, nrOfElements, key,
+                            CountingSortBudget(nrOfElements))) {
+    RadixSortByKey(elements, nrOfElements, key);
+  }
+}
+
+// --- Adaptive dispatch ---
+
+enum class AutoSortPath {
+  Trivial,
+  AlreadySorted,
+  Reversed,
+  Counting,
+  RunMerge,
+  ThreeWayQuicksort,
+  Radix,
+  Introsort
+};
+
+inline const char *AutoSortPathName(AutoSortPath path) {
+  switch (path) {
+  case AutoSortPath::Trivial:
+    return "trivial";
+  case AutoSortPath::AlreadySorted:
+    return "already sorted";
+  case AutoSortPath::Reversed:
+    return "reversed";
+  case AutoSortPath::Counting:
+    return "counting";
+  case AutoSortPath::RunMerge:
+    return "run merge";
+  case AutoSortPath::ThreeWayQuicksort:
+    return "three way quicksort";
+  case AutoSortPath::Radix:
+    return "radix";
+  case AutoSortPath::Introsort:
+    return "introsort";
+  }
+  return "unknown";
+}
+
+struct PresortednessProfile {
+  int runs = 0;          // Maximal non-descending runs, from a full scan
+  int descents = 0;      // Positions where elements[i + 1] < elements[i]
+  double inversion_ratio = 0; // Sampled fraction of inverted pairs, 0.5 ~ random
+  double duplicate_ratio = 0; // Sampled fraction of repeated keys
+};
+
+// One O(n) pass for runs plus fixed size samples for inversions and
+// duplicates, so the scan stays cheap next to the sort it picks.
+template <class T>
+PresortednessProfile ScanPresortedness(T elements[], int nrOfElements) {
+  PresortednessProfile profile;
+  if (nrOfElements <= 1) {
+    profile.runs = nrOfElements;
+    return profile;
+  }
+  profile.runs = 1;
+  for (int i = 1; i < nrOfElements; i++) {
+    if (elements[i] < elements[i - 1]) {
+      profile.descents++;
+      profile.runs++;
+    }
+  }
+
+  const int pair_samples = std::min(nrOfElements, 256);
+  unsigned state = 0x9E3779B9u ^ unsigned(nrOfElements);
+  int inversions = 0;
+  for (int s = 0; s < pair_samples; s++) {
+    state = state * 1664525u + 1013904223u;
+    int i = int((state >> 8) % unsigned(nrOfElements));
+    state = state * 1664525u + 1013904223u;
+    int j = int((state >> 8) % unsigned(nrOfElements));
+    if (i == j) {
+      continue;
+    }
+    if (j < i) {
+      std::swap(i, j);
+    }
+    if (elements[j] < elements[i]) {
+      inversions++;
+    }
+  }
+  profile.inversion_ratio = double(inversions) / pair_samples;
+
+  const int key_samples = std::min(nrOfElements, 128);
+  T *sample = new T[key_samples];
+  for (int s = 0; s < key_samples; s++) {
+    sample[s] = elements[(long long)s * nrOfElements / key_samples];
+  }
+  InsertionsortRange(sample, 0, key_samples - 1);
+  int repeated = 0;
+  for (int s = 1; s < key_samples; s++) {
+    if (!(sample[s - 1] < sample[s])) {
+      repeated++;
+    }
+  }
+  delete[] sample;
+  profile.duplicate_ratio = double(repeated) / key_samples;
+  return profile;
+}
+
+template <class T>
+AutoSortPath AutoSortReport(T elements[], int nrOfElements,
+                            PresortednessProfile *out_profile = nullptr) {
+  if (nrOfElements <= 1) {
+    return AutoSortPath::Trivial;
+  }
+  PresortednessProfile profile = ScanPresortedness(elements, nrOfElements);
+  if (out_profile) {
+    *out_profile = profile;
+  }
+
+  if (profile.descents == 0) {
+    return AutoSortPath::AlreadySorted;
+  }
+  if (profile.descents == nrOfElements - 1) {
+    std::reverse(elements, elements + nrOfElements);
+    return AutoSortPath::Reversed;
+  }
+  if constexpr (std::is_integral<T>::value) {
+    if (nrOfElements >= 64 &&
+        TryCountingSort(elements, nrOfElements, 2LL * nrOfElements)) {
+      return AutoSortPath::Counting;
+    }
+    if (nrOfElements >= 64) {
+      RadixSort(elements, nrOfElements);
+      return AutoSortPath::Radix;
+    }
+  }
+  if (profile.runs <= nrOfElements / 8 || profile.inversion_ratio < 0.05) {
+    RunMergesort(elements, nrOfElements);
+    return AutoSortPath::RunMerge;
+  }
+  if (profile.duplicate_ratio >= 0.25) {
+    QuicksortThreeWay(elements, nrOfElements);
+    return AutoSortPath::ThreeWayQuicksort;
+  }
+  Introsort(elements, nrOfElements);
+  return AutoSortPath::Introsort;
+}
+
+template <class T> void AutoSort(T elements[], int nrOfElements) {
+  AutoSortReport(elements, nrOfElements);
+}
+
 #endif
@@ -1,12 +1,410 @@
+#include "../a1/a1.h"
+#include "ColumnarSort.h"
+#include "SegmentedSort.h"
+#include "SortingNetwork.h"
 #include "a2.h"
+#include <cmath>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <include/benchmark.hpp>
+#include <include/counted.hpp>
 #include <include/testing>
+#include <include/functions.hpp>
 using std::string;
 using testing::AlgorithmTestConfig;
 using testing_utils::print_colored_line;
 using testing::test_all_algorithms;
+using testing_framework::ControlStatsSnapshot;
+using testing_framework::Counted;
+using testing_framework::Record;
 using testing_framework::Testing;
-int main() {
+using testing_framework::ThreadLocalCounterPolicy;
+
+static_assert(NetworkSorted(std::array<int, 5>{5, 1, 4, 2, 3})[0] == 1 &&
+                  NetworkSorted(std::array<int, 5>{5, 1, 4, 2, 3})[4] == 5,
+              "NetworkSort must be usable in constant expressions");
+
+// Checks the network for N against Insertionsort on every distribution, and
+// on all 2^N zero/one inputs, which by the 0-1 principle proves it sorts.
+template <int N> bool verify_sorting_network(unsigned long long seed) {
+  bool passed = true;
+  for (const auto &distribution : testing_functions::distributions()) {
+    std::array<Testing, N> expected;
+    testing_functions::Random rng(
+        testing_functions::case_seed(seed, distribution.first, N));
+    distribution.second(expected.data(), N, rng);
+    std::array<Testing, N> actual = expected;
+    Insertionsort(expected.data(), N);
+    NetworkSort(actual);
+    passed &= std::equal(actual.begin(), actual.end(), expected.begin());
+  }
+  for (unsigned long bits = 0; bits < (1ul << N); bits++) {
+    std::array<int, N> zero_one;
+    for (int i = 0; i < N; i++) {
+      zero_one[i] = (bits >> i) & 1;
+    }
+    NetworkSort(zero_one);
+    passed &= std::is_sorted(zero_one.begin(), zero_one.end());
+  }
+  std::cout << "  Sorting network N=" << N << " ("
+            << SortingNetwork<N>::comparators.size() << " comparators): ";
+  print_colored_line(passed ? "Passed" : "FAILED",
+                     passed ? testing_utils::BOLD_GREEN
+                            : testing_utils::BOLD_RED);
+  return passed;
+}
+
+// Sorts one batch of segments with SegmentedSort and with std::sort per
+// segment and compares the results.
+bool segmented_sort_matches(const std::vector<int> &sizes, bool all_equal,
+                            int nrOfThreads, testing_functions::Random &rng) {
+  std::vector<int> offsets = {0};
+  for (int size : sizes) {
+    offsets.push_back(offsets.back() + size);
+  }
+  std::vector<int> values(offsets.back());
+  for (int &value : values) {
+    value = all_equal ? 7 : testing_functions::uniform_below(rng, 1000) - 500;
+  }
+  std::vector<int> expected = values;
+  for (size_t s = 0; s < sizes.size(); s++) {
+    std::sort(expected.begin() + offsets[s], expected.begin() + offsets[s + 1]);
+  }
+  SegmentedSort(values.data(), offsets.data(), int(sizes.size()), nrOfThreads);
+  return values == expected;
+}
+
+// No segments, empty segments between others, single segments of every
+// kernel's size, all-equal keys, and enough elements for the threaded split.
+bool verify_segmented_sort(unsigned long long seed) {
+  testing_functions::Random rng(seed);
+  std::vector<int> every_size;
+  for (int size = 0; size <= 40; size++) {
+    every_size.push_back(size);
+  }
+  std::vector<int> many;
+  for (int s = 0; s < 3000; s++) {
+    many.push_back(testing_functions::uniform_below(rng, 80));
+  }
+  std::vector<int> one_huge = many;
+  one_huge[1500] = 100000;
+
+  bool passed = segmented_sort_matches({}, false, 1, rng) &
+                segmented_sort_matches({0}, false, 1, rng) &
+                segmented_sort_matches({0, 5, 0, 0, 17, 0, 1, 0}, false, 1,
+                                       rng) &
+                segmented_sort_matches(every_size, false, 1, rng) &
+                segmented_sort_matches(every_size, true, 1, rng) &
+                segmented_sort_matches(many, false, 4, rng) &
+                segmented_sort_matches(many, true, 4, rng) &
+                segmented_sort_matches(one_huge, false, 4, rng);
+  for (int size : {1, 2, 16, 17, 32, 33, 1000}) {
+    passed &= segmented_sort_matches({size}, false, 1, rng);
+    passed &= segmented_sort_matches({size}, true, 1, rng);
+  }
+  std::cout << "  Segmented sort vs std::sort: ";
+  print_colored_line(passed ? "Passed" : "FAILED",
+                     passed ? testing_utils::BOLD_GREEN
+                            : testing_utils::BOLD_RED);
+  return passed;
+}
+
+// IEEE 754 totalOrder for the values the columnar check uses: -0.0 before
+// +0.0, and (positive) NaNs after everything else.
+template <class F> bool total_order_less(F a, F b) {
+  if (std::isnan(a) || std::isnan(b)) {
+    return !std::isnan(a);
+  }
+  if (a == b) {
+    return std::signbit(a) && !std::signbit(b);
+  }
+  return a < b;
+}
+
+// Checks ColumnarSortPermutation against std::stable_sort of the row numbers
+// with a lexicographic comparator: int and float keys, which pack into one
+// 64 bit key, then int, float and a descending double, which are sorted
+// column by column. The float column has NaN, both zeros and infinities.
+bool verify_columnar_sort(unsigned long long seed) {
+  const int nrOfRows = 5000;
+  testing_functions::Random rng(seed);
+  const float specials[] = {std::numeric_limits<float>::quiet_NaN(),
+                            -0.0f,
+                            0.0f,
+                            std::numeric_limits<float>::infinity(),
+                            -std::numeric_limits<float>::infinity()};
+  std::vector<int> ints(nrOfRows);
+  std::vector<float> floats(nrOfRows);
+  std::vector<double> doubles(nrOfRows);
+  for (int row = 0; row < nrOfRows; row++) {
+    ints[row] = testing_functions::uniform_below(rng, 8) - 4;
+    int pick = testing_functions::uniform_below(rng, 10);
+    floats[row] = pick < 5 ? specials[pick]
+                           : float(testing_functions::uniform_below(rng, 7)) -
+                                 3.5f;
+    doubles[row] = double(testing_functions::uniform_below(rng, 5)) - 2.0;
+  }
+
+  std::vector<int> expected(nrOfRows);
+  for (int row = 0; row < nrOfRows; row++) {
+    expected[row] = row;
+  }
+  std::vector<int> expected_three = expected;
+  std::stable_sort(expected.begin(), expected.end(), [&](int a, int b) {
+    if (ints[a] != ints[b]) {
+      return ints[a] < ints[b];
+    }
+    return total_order_less(floats[a], floats[b]);
+  });
+  std::stable_sort(
+      expected_three.begin(), expected_three.end(), [&](int a, int b) {
+        if (ints[a] != ints[b]) {
+          return ints[a] < ints[b];
+        }
+        if (total_order_less(floats[a], floats[b]) ||
+            total_order_less(floats[b], floats[a])) {
+          return total_order_less(floats[a], floats[b]);
+        }
+        return doubles[a] > doubles[b];
+      });
+
+  bool passed =
+      ColumnarSortPermutation(nrOfRows, KeyColumn<int>{ints.data()},
+                              KeyColumn<float>{floats.data()}) == expected;
+  passed &= ColumnarSortPermutation(
+                nrOfRows, KeyColumn<int>{ints.data()},
+                KeyColumn<float>{floats.data()},
+                KeyColumn<double>{doubles.data(), SortOrder::Descending}) ==
+            expected_three;
+
+  // Gathering a row id column with the permutation reproduces it.
+  std::vector<int> ids(nrOfRows);
+  for (int row = 0; row < nrOfRows; row++) {
+    ids[row] = row;
+  }
+  GatherColumns(expected, ids.data());
+  passed &= ids == expected;
+
+  std::cout << "  Columnar sort vs std::stable_sort: ";
+  print_colored_line(passed ? "Passed" : "FAILED",
+                     passed ? testing_utils::BOLD_GREEN
+                            : testing_utils::BOLD_RED);
+  return passed;
+}
+
+// Copies values into an array, sorts it with sort and compares the result
+// with std::sort.
+template <class T, class Sort>
+bool sort_matches(std::vector<T> values, Sort sort) {
+  std::vector<T> expected = values;
+  std::sort(expected.begin(), expected.end());
+  sort(values.data(), int(values.size()));
+  return values == expected;
+}
+
+// 64 bit keys at both ends of their range, where a signed key distance would
+// wrap: straight through the counting sorts, and through AutoSort, which
+// picks counting sort for 100 keys of only two values.
+bool verify_counting_sort_wide_keys() {
+  const unsigned long long umax =
+      std::numeric_limits<unsigned long long>::max();
+  const long long smin = std::numeric_limits<long long>::min();
+  const long long smax = std::numeric_limits<long long>::max();
+  std::vector<unsigned long long> two_ends;
+  std::vector<unsigned long long> top;
+  std::vector<long long> signed_ends;
+  for (int i = 0; i < 100; i++) {
+    two_ends.push_back(i % 2 ? umax : 0);
+    top.push_back(umax - (i * 37) % 100);
+    signed_ends.push_back(i % 3 == 0 ? smin : i % 3 == 1 ? smax : 0);
+  }
+  auto counting = [](auto elements[], int nrOfElements) {
+    CountingSort(elements, nrOfElements);
+  };
+  auto automatic = [](auto elements[], int nrOfElements) {
+    AutoSort(elements, nrOfElements);
+  };
+  auto by_key = [](unsigned long long elements[], int nrOfElements) {
+    CountingSortByKey(elements, nrOfElements,
+                      [](unsigned long long key) { return key; });
+  };
+  bool passed = sort_matches(std::vector<unsigned long long>{umax, 0},
+                             counting) &
+                sort_matches(two_ends, counting) &
+                sort_matches(two_ends, automatic) &
+                sort_matches(two_ends, by_key) & sort_matches(top, counting) &
+                sort_matches(top, automatic) & sort_matches(top, by_key) &
+                sort_matches(signed_ends, counting) &
+                sort_matches(signed_ends, automatic);
+  std::cout << "  Counting sort with 64 bit keys vs std::sort: ";
+  print_colored_line(passed ? "Passed" : "FAILED",
+                     passed ? testing_utils::BOLD_GREEN
+                            : testing_utils::BOLD_RED);
+  return passed;
+}
+
+// Runs the suite, its report discarded, on a sort that leaves one pair out
+// of order and on one that throws, each serially and on a pool; every run
+// has to come back failed.
+bool verify_broken_sorts_fail() {
+  auto unsorted = [](Testing elements[], int nrOfElements) {
+    Introsort(elements, nrOfElements);
+    if (nrOfElements >= 2) {
+      std::swap(elements[0], elements[nrOfElements - 1]);
+    }
+  };
+  auto throwing = [](Testing elements[], int nrOfElements) {
+    if (nrOfElements >= 50) {
+      throw std::out_of_range("deliberately broken sort");
+    }
+    Introsort(elements, nrOfElements);
+  };
+  bool passed = true;
+  std::ostringstream discarded;
+  std::streambuf *stdout_buffer = std::cout.rdbuf(discarded.rdbuf());
+  for (int threads : {1, 2}) {
+    std::vector<AlgorithmTestConfig> broken = {
+        {"introsort", Introsort<Testing>},
+        {"unsorted", unsorted},
+        {"throwing", throwing},
+    };
+    for (AlgorithmTestConfig &config : broken) {
+      config.options.threads = threads;
+    }
+    passed &= test_all_algorithms({broken[0]}) == 0;
+    passed &= test_all_algorithms({broken[0], broken[1]}) != 0;
+    passed &= test_all_algorithms({broken[2], broken[0]}) != 0;
+  }
+  std::cout.rdbuf(stdout_buffer);
+  std::cout << "  Broken sorts fail the suite: ";
+  print_colored_line(passed ? "Passed" : "FAILED",
+                     passed ? testing_utils::BOLD_GREEN
+                            : testing_utils::BOLD_RED);
+  return passed;
+}
+
+// Sorts the same random keys as records of Bytes bytes. The comparisons and
+// moves do not depend on the record size, but every move copies the whole
+// record, so this shows which algorithms pay for moving data around.
+template <size_t Bytes> void benchmark_record_size(int nrOfElements) {
+  using Element = Counted<Record<Bytes>, ThreadLocalCounterPolicy>;
+  static_assert(sizeof(Element) == Bytes, "Counted adds no per object state");
+  const int repetitions = 5;
+  std::vector<std::pair<string, std::function<void(Element[], int)>>> sorts =
+      {
+          {"mergesortBook", MergesortBook<Element>},
+          {"mergesort", Mergesort<Element>},
+          {"heapsort", Heapsort<Element>},
+          {"quicksortHoare", QuicksortHoare<Element>},
+          {"introsort", Introsort<Element>},
+          {"quicksortThreeWay", QuicksortThreeWay<Element>},
+          {"runMergesort", RunMergesort<Element>},
+          {"autosort", AutoSort<Element>},
+      };
+
+  std::mt19937 generator(12345);
+  std::vector<Element> input;
+  for (int i = 0; i < nrOfElements; i++) {
+    input.emplace_back(int(generator() % nrOfElements));
+  }
+  std::vector<Element> work;
+  for (const auto &sort : sorts) {
+    double best_ns = 0;
+    ControlStatsSnapshot counts;
+    for (int r = 0; r < repetitions; r++) {
+      work = input;
+      ThreadLocalCounterPolicy::reset_and_get_snapshot();
+      testing_benchmark::Clock::time_point start =
+          testing_benchmark::Clock::now();
+      sort.second(work.data(), nrOfElements);
+      double ns = testing_benchmark::elapsed_ns(
+          start, testing_benchmark::Clock::now());
+      counts = ThreadLocalCounterPolicy::reset_and_get_snapshot();
+      best_ns = r == 0 ? ns : std::min(best_ns, ns);
+    }
+    std::cout << std::left << std::setw(20) << sort.first << std::setw(8)
+              << Bytes << std::fixed << std::setprecision(2) << std::setw(12)
+              << best_ns / 1e6 << std::setw(12) << best_ns / nrOfElements
+              << std::defaultfloat << std::setw(14)
+              << counts.total_comparisons() << std::setw(14)
+              << counts.total_data_moves() << std::endl;
+  }
+}
+
+void benchmark_record_sizes() {
+  const int nrOfElements = 1 << 15;
+  print_colored_line("===== Record Size Benchmark (n = " +
+                         std::to_string(nrOfElements) + ") =====",
+                     testing_utils::BOLD_CYAN);
+  std::cout << std::left << std::setw(20) << "Algorithm" << std::setw(8)
+            << "Bytes" << std::setw(12) << "Time (ms)" << std::setw(12)
+            << "ns/elem" << std::setw(14) << "Comparisons" << std::setw(14)
+            << "Data Moves" << std::endl;
+  std::cout << std::string(80, '-') << std::endl;
+  benchmark_record_size<4>(nrOfElements);
+  benchmark_record_size<16>(nrOfElements);
+  benchmark_record_size<64>(nrOfElements);
+  benchmark_record_size<256>(nrOfElements);
+  std::cout << std::string(80, '-') << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  // --timing adds wall-clock statistics to every test case, --counters
+  // hardware performance counters, --adversary McIlroy worst case inputs,
+  // --seed N replays the inputs of an earlier run, --threads N spreads the
+  // cases over N threads, --json FILE and --csv FILE also write every case
+  // to FILE. --records only runs the record size benchmark.
+  bool timing = false;
+  bool counters = false;
+  bool adversary = false;
+  unsigned long long seed = testing_framework::DefaultInputSeed;
+  int threads = 1;
+  std::string json_path;
+  std::string csv_path;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    timing = timing || arg == "--timing";
+    counters = counters || arg == "--counters";
+    adversary = adversary || arg == "--adversary";
+    if (arg == "--seed" && i + 1 < argc) {
+      seed = std::stoull(argv[++i]);
+    }
+    if (arg == "--threads" && i + 1 < argc) {
+      threads = std::stoi(argv[++i]);
+    }
+    if (arg == "--json" && i + 1 < argc) {
+      json_path = argv[++i];
+    }
+    if (arg == "--csv" && i + 1 < argc) {
+      csv_path = argv[++i];
+    }
+    if (arg == "--records") {
+      benchmark_record_sizes();
+      return 0;
+    }
+  }
+
+  print_colored_line(
+      "===== Sorting Networks, Segmented, Columnar and Counting Sort =====",
+      testing_utils::BOLD_CYAN);
+  bool networks_passed = verify_sorting_network<3>(seed) &
+                         verify_sorting_network<4>(seed) &
+                         verify_sorting_network<5>(seed) &
+                         verify_sorting_network<6>(seed) &
+                         verify_sorting_network<7>(seed) &
+                         verify_sorting_network<8>(seed) &
+                         verify_sorting_network<16>(seed);
+  networks_passed &= verify_segmented_sort(seed);
+  networks_passed &= verify_columnar_sort(seed);
+  networks_passed &= verify_counting_sort_wide_keys();
+  networks_passed &= verify_broken_sorts_fail();
+
   std::vector<AlgorithmTestConfig> algorithms = {
       {"mergesortBook", MergesortBook<Testing>},
       {"mergesort", Mergesort<Testing>},
@@ -15,10 +413,32 @@ int main() {
       {"quicksortHoareimpproved", QuicksortHoareImproved<Testing>},
       {"quicksortHoaremedian3", QuicksortHoareImprovedMedian3<Testing>},
       {"quicksortHoare", QuicksortHoare<Testing>},
+      {"introsort", Introsort<Testing>},
+      {"quicksortThreeWay", QuicksortThreeWay<Testing>},
+      {"runMergesort", RunMergesort<Testing>},
+      {"autosort", AutoSort<Testing>},
+      {"countingSortByKey",
+       [](Testing elements[], int nrOfElements) {
+         CountingSortByKey(elements, nrOfElements,
+                           [](const Testing &t) { return t.get_value(); });
+       }},
   };
 
+  for (AlgorithmTestConfig &config : algorithms) {
+    config.options.timing = timing;
+    config.options.hardware_counters = counters;
+    config.options.adversary = adversary;
+    config.options.seed = seed;
+    config.options.threads = threads;
+    config.options.json_path = json_path;
+    config.options.csv_path = csv_path;
+  }
+
   // Run the tests for all configured algorithms
   int final_status = test_all_algorithms(algorithms);
+  if (!networks_passed) {
+    final_status = 1;
+  }
 
   // Report final overall status based on the summary function's return
   std::cout << "\nOverall Test Suite Result: ";
@@ -0,0 +1,156 @@
+#ifndef DEQUEWORKSTEALING_H
+#define DEQUEWORKSTEALING_H
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque, after Le, Pop, Cohen and Zappa Nardelli,
+// "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+// Their seq_cst fences are folded into seq_cst accesses of top and bottom,
+// which costs the same on x86 and is something ThreadSanitizer understands.
+//
+// The owning thread pushes and pops at the bottom like a stack; any other
+// thread may steal from the top like a queue. Owner operations only touch
+// bottom until the deque is nearly empty, and the last element is settled by
+// a CAS on top that both sides race for. The circular array grows when full;
+// old arrays are kept until the deque dies because a thief may still be
+// reading one. T is stored in atomics, so it must be trivially copyable
+// (typically a task pointer).
+template <typename T> class DequeWorkStealing {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "DequeWorkStealing stores T in std::atomic");
+
+private:
+  static const int CacheLine = 64;
+
+  struct Array {
+    long long capacity;
+    long long mask;
+    std::atomic<T> *slots;
+
+    Array(long long capacity)
+        : capacity(capacity), mask(capacity - 1),
+          slots(new std::atomic<T>[capacity]) {}
+    ~Array() { delete[] slots; }
+
+    T get(long long index) const {
+      return slots[index & mask].load(std::memory_order_relaxed);
+    }
+    void put(long long index, T value) {
+      slots[index & mask].store(value, std::memory_order_relaxed);
+    }
+  };
+
+  alignas(CacheLine) std::atomic<long long> top{0};
+  alignas(CacheLine) std::atomic<long long> bottom{0};
+  alignas(CacheLine) std::atomic<Array *> array;
+  std::vector<Array *> retired; // Owner only
+
+  Array *grow(Array *old, long long bottomIndex, long long topIndex);
+
+public:
+  DequeWorkStealing(int initialCapacity = 256);
+  virtual ~DequeWorkStealing();
+  DequeWorkStealing(const DequeWorkStealing &other) = delete;
+  DequeWorkStealing &operator=(const DequeWorkStealing &other) = delete;
+
+  // Owner thread only.
+  void push(T element);
+  bool pop(T &element);
+
+  // Any thread. May fail spuriously when it loses a race for the last
+  // element or with another thief.
+  bool steal(T &element);
+
+  // Snapshots; exact only when no other thread is active.
+  bool isEmpty() const;
+  int size() const;
+};
+
+template <typename T>
+inline DequeWorkStealing<T>::DequeWorkStealing(int initialCapacity) {
+  long long capacity = 1;
+  while (capacity < initialCapacity) {
+    capacity <<= 1;
+  }
+  array.store(new Array(capacity), std::memory_order_relaxed);
+}
+
+template <typename T> inline DequeWorkStealing<T>::~DequeWorkStealing() {
+  delete array.load(std::memory_order_relaxed);
+  for (Array *old : retired) {
+    delete old;
+  }
+}
+
+template <typename T>
+inline typename DequeWorkStealing<T>::Array *
+DequeWorkStealing<T>::grow(Array *old, long long bottomIndex,
+                           long long topIndex) {
+  Array *grown = new Array(old->capacity * 2);
+  for (long long i = topIndex; i < bottomIndex; i++) {
+    grown->put(i, old->get(i));
+  }
+  retired.push_back(old);
+  array.store(grown, std::memory_order_release);
+  return grown;
+}
+
+template <typename T> inline void DequeWorkStealing<T>::push(T element) {
+  long long b = bottom.load(std::memory_order_relaxed);
+  long long t = top.load(std::memory_order_acquire);
+  Array *a = array.load(std::memory_order_relaxed);
+  if (b - t > a->capacity - 1) {
+    a = grow(a, b, t);
+  }
+  a->put(b, element);
+  bottom.store(b + 1, std::memory_order_release);
+}
+
+template <typename T> inline bool DequeWorkStealing<T>::pop(T &element) {
+  long long b = bottom.load(std::memory_order_relaxed) - 1;
+  Array *a = array.load(std::memory_order_relaxed);
+  bottom.store(b, std::memory_order_seq_cst);
+  long long t = top.load(std::memory_order_seq_cst);
+  if (t > b) {
+    bottom.store(b + 1, std::memory_order_relaxed); // Was already empty
+    return false;
+  }
+  element = a->get(b);
+  if (t == b) {
+    // Last element: thieves may be after it too, whoever moves top wins.
+    bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return won;
+  }
+  return true;
+}
+
+template <typename T> inline bool DequeWorkStealing<T>::steal(T &element) {
+  long long t = top.load(std::memory_order_seq_cst);
+  long long b = bottom.load(std::memory_order_seq_cst);
+  if (t >= b) {
+    return false;
+  }
+  Array *a = array.load(std::memory_order_acquire);
+  T stolen = a->get(t);
+  if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                   std::memory_order_relaxed)) {
+    return false;
+  }
+  element = stolen;
+  return true;
+}
+
+template <typename T> inline bool DequeWorkStealing<T>::isEmpty() const {
+  return size() == 0;
+}
+
+template <typename T> inline int DequeWorkStealing<T>::size() const {
+  long long b = bottom.load(std::memory_order_acquire);
+  long long t = top.load(std::memory_order_acquire);
+  return b > t ? int(b - t) : 0;
+}
+
+#endif
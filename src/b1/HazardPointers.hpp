@@ -0,0 +1,138 @@
+#ifndef HAZARDPOINTERS_H
+#define HAZARDPOINTERS_H
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Safe memory reclamation for lock-free structures. Before dereferencing a
+// shared node a thread publishes its address in its hazard slot and re-checks
+// that the node is still reachable. Removed nodes are retired instead of
+// deleted, and a retired node is only freed once no hazard slot points at it.
+// Because a protected node cannot be freed, it cannot be reallocated at the
+// same address either, which is what rules out ABA on a CAS against it.
+//
+// One process wide domain, like Control; each thread claims one slot on first
+// use and gives it back (along with anything it could not free yet) when the
+// thread exits.
+class HazardPointers {
+public:
+  static const int MaxThreads = 128;
+  static const int ScanThreshold = 2 * MaxThreads;
+
+  HazardPointers(const HazardPointers &) = delete;
+  HazardPointers &operator=(const HazardPointers &) = delete;
+
+  static HazardPointers &get_instance() {
+    static HazardPointers instance;
+    return instance;
+  }
+
+  // The calling thread's hazard slot.
+  std::atomic<void *> &hazard() { return thread_state().slot->pointer; }
+
+  // Loads source and publishes it as hazardous until the value is stable, so
+  // the returned node stays valid until the hazard is cleared.
+  template <typename Node> Node *protect(const std::atomic<Node *> &source) {
+    std::atomic<void *> &slot = hazard();
+    Node *node = source.load();
+    while (true) {
+      slot.store(node);
+      Node *current = source.load();
+      if (current == node) {
+        return node;
+      }
+      node = current;
+    }
+  }
+
+  void clear() { hazard().store(nullptr, std::memory_order_release); }
+
+  template <typename Node> void retire(Node *node) {
+    ThreadState &state = thread_state();
+    state.retired.push_back(
+        {node, [](void *pointer) { delete static_cast<Node *>(pointer); }});
+    if (int(state.retired.size()) >= ScanThreshold) {
+      scan(state.retired);
+    }
+  }
+
+private:
+  struct alignas(64) Slot {
+    std::atomic<bool> active{false};
+    std::atomic<void *> pointer{nullptr};
+  };
+
+  struct Retired {
+    void *pointer;
+    void (*deleter)(void *);
+  };
+
+  struct ThreadState {
+    Slot *slot;
+    std::vector<Retired> retired;
+
+    ThreadState() : slot(get_instance().claim_slot()) {}
+    ~ThreadState() {
+      HazardPointers &domain = get_instance();
+      slot->pointer.store(nullptr);
+      domain.scan(retired);
+      slot->active.store(false, std::memory_order_release);
+      std::lock_guard<std::mutex> guard(domain.orphanLock);
+      domain.orphans.insert(domain.orphans.end(), retired.begin(),
+                            retired.end());
+    }
+  };
+
+  Slot slots[MaxThreads];
+  std::mutex orphanLock;
+  std::vector<Retired> orphans; // Left behind by exited threads
+
+  HazardPointers() = default;
+
+  static ThreadState &thread_state() {
+    static thread_local ThreadState state;
+    return state;
+  }
+
+  Slot *claim_slot() {
+    for (Slot &slot : slots) {
+      bool expected = false;
+      if (!slot.active.load(std::memory_order_relaxed) &&
+          slot.active.compare_exchange_strong(expected, true)) {
+        return &slot;
+      }
+    }
+    throw std::runtime_error("HazardPointers: more than MaxThreads threads");
+  }
+
+  // Frees every retired node no thread has published, keeps the rest.
+  void scan(std::vector<Retired> &retired) {
+    {
+      std::lock_guard<std::mutex> guard(orphanLock);
+      retired.insert(retired.end(), orphans.begin(), orphans.end());
+      orphans.clear();
+    }
+    std::vector<void *> hazards;
+    for (Slot &slot : slots) {
+      if (slot.active.load()) {
+        if (void *pointer = slot.pointer.load()) {
+          hazards.push_back(pointer);
+        }
+      }
+    }
+    std::sort(hazards.begin(), hazards.end());
+    std::vector<Retired> kept;
+    for (const Retired &node : retired) {
+      if (std::binary_search(hazards.begin(), hazards.end(), node.pointer)) {
+        kept.push_back(node);
+      } else {
+        node.deleter(node.pointer);
+      }
+    }
+    retired.swap(kept);
+  }
+};
+
+#endif
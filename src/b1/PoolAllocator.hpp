@@ -0,0 +1,197 @@
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Node allocators for the linked containers (StackLinkedList,
+// QueueLinkedList). A container takes one as a template template parameter
+// and keeps an Allocator<Node> member; all it needs is
+//   Node *create(args...)  constructs a node
+//   void destroy(Node *)   destroys and releases it
+//   size_t bytesReserved() memory currently held for nodes
+
+// Plain new/delete, the default.
+template <typename Node> class NewDeleteAllocator {
+public:
+  template <typename... Args> Node *create(Args &&...args) {
+    return new Node(std::forward<Args>(args)...);
+  }
+  void destroy(Node *node) { delete node; }
+  size_t bytesReserved() const { return 0; } // Owned by the heap
+};
+
+// Carves nodes out of large slabs and keeps freed ones on an intrusive free
+// list, so pushing and popping reuse the same few cache lines instead of
+// going through malloc per element. Slabs double in size (up to a cap) and
+// are only released when the allocator dies. Not thread safe: one per
+// container.
+template <typename Node> class PoolAllocator {
+private:
+  union Block {
+    Block *next;
+    alignas(Node) unsigned char storage[sizeof(Node)];
+  };
+
+  static const int FirstSlabBlocks = 64;
+  static const int MaxSlabBlocks = 1 << 16;
+
+  std::vector<Block *> slabs;
+  Block *freeList = nullptr;
+  Block *slabCursor = nullptr; // Next never used block in the newest slab
+  Block *slabEnd = nullptr;
+  int nextSlabBlocks = FirstSlabBlocks;
+  size_t reserved = 0;
+
+  Block *takeBlock() {
+    if (freeList != nullptr) {
+      Block *block = freeList;
+      freeList = block->next;
+      return block;
+    }
+    if (slabCursor == slabEnd) {
+      Block *slab = static_cast<Block *>(
+          ::operator new(sizeof(Block) * size_t(nextSlabBlocks)));
+      slabs.push_back(slab);
+      reserved += sizeof(Block) * size_t(nextSlabBlocks);
+      slabCursor = slab;
+      slabEnd = slab + nextSlabBlocks;
+      if (nextSlabBlocks < MaxSlabBlocks) {
+        nextSlabBlocks *= 2;
+      }
+    }
+    return slabCursor++;
+  }
+
+public:
+  PoolAllocator() = default;
+  PoolAllocator(const PoolAllocator &) = delete;
+  PoolAllocator &operator=(const PoolAllocator &) = delete;
+  ~PoolAllocator() {
+    for (Block *slab : slabs) {
+      ::operator delete(slab);
+    }
+  }
+
+  template <typename... Args> Node *create(Args &&...args) {
+    Block *block = takeBlock();
+    try {
+      return ::new (static_cast<void *>(block->storage))
+          Node(std::forward<Args>(args)...);
+    } catch (...) {
+      block->next = freeList;
+      freeList = block;
+      throw;
+    }
+  }
+
+  void destroy(Node *node) {
+    node->~Node();
+    Block *block = reinterpret_cast<Block *>(node);
+    block->next = freeList;
+    freeList = block;
+  }
+
+  size_t bytesReserved() const { return reserved; }
+};
+
+// One pool per Node type shared by every container and thread, fronted by a
+// small thread local cache of free blocks. Threads only take the global lock
+// to move CacheBatch blocks at a time between their cache and the pool, so
+// nodes can be created on one thread and destroyed on another.
+template <typename Node> class SharedPoolAllocator {
+private:
+  union Block {
+    Block *next;
+    alignas(Node) unsigned char storage[sizeof(Node)];
+  };
+
+  static const int CacheBatch = 256;
+  static const int SlabBlocks = 1 << 14;
+
+  struct Pool {
+    std::mutex lock;
+    std::vector<Block *> slabs;
+    std::vector<Block *> freeBlocks;
+    size_t reserved = 0;
+
+    ~Pool() {
+      for (Block *slab : slabs) {
+        ::operator delete(slab);
+      }
+    }
+
+    void refill(std::vector<Block *> &cache) {
+      std::lock_guard<std::mutex> guard(lock);
+      if (freeBlocks.empty()) {
+        Block *slab = static_cast<Block *>(
+            ::operator new(sizeof(Block) * size_t(SlabBlocks)));
+        slabs.push_back(slab);
+        reserved += sizeof(Block) * size_t(SlabBlocks);
+        for (int i = 0; i < SlabBlocks; i++) {
+          freeBlocks.push_back(slab + i);
+        }
+      }
+      size_t take = std::min(freeBlocks.size(), size_t(CacheBatch));
+      cache.insert(cache.end(), freeBlocks.end() - take, freeBlocks.end());
+      freeBlocks.resize(freeBlocks.size() - take);
+    }
+
+    void giveBack(std::vector<Block *> &cache, size_t count) {
+      std::lock_guard<std::mutex> guard(lock);
+      freeBlocks.insert(freeBlocks.end(), cache.end() - count, cache.end());
+      cache.resize(cache.size() - count);
+    }
+  };
+
+  struct Cache {
+    std::vector<Block *> blocks;
+    ~Cache() { pool().giveBack(blocks, blocks.size()); }
+  };
+
+  static Pool &pool() {
+    static Pool instance;
+    return instance;
+  }
+
+  static std::vector<Block *> &cache() {
+    static thread_local Cache instance;
+    return instance.blocks;
+  }
+
+public:
+  template <typename... Args> Node *create(Args &&...args) {
+    std::vector<Block *> &blocks = cache();
+    if (blocks.empty()) {
+      pool().refill(blocks);
+    }
+    Block *block = blocks.back();
+    blocks.pop_back();
+    try {
+      return ::new (static_cast<void *>(block->storage))
+          Node(std::forward<Args>(args)...);
+    } catch (...) {
+      blocks.push_back(block);
+      throw;
+    }
+  }
+
+  void destroy(Node *node) {
+    node->~Node();
+    std::vector<Block *> &blocks = cache();
+    blocks.push_back(reinterpret_cast<Block *>(node));
+    if (int(blocks.size()) >= 2 * CacheBatch) {
+      pool().giveBack(blocks, CacheBatch);
+    }
+  }
+
+  size_t bytesReserved() const {
+    std::lock_guard<std::mutex> guard(pool().lock);
+    return pool().reserved;
+  }
+};
+
+#endif
@@ -1,44 +1,174 @@
 #ifndef QUEUEARRAY_H
 #define QUEUEARRAY_H
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
+// Growable ring buffer. The capacity is always a power of two so a position
+// maps to a slot with a mask instead of a modulo. head and tail count up
+// without wrapping back; only their masked values index the storage, and
+// tail - head is the size even after the counters overflow.
 template <typename T> class QueueArray {
 private:
   T *elements;
   int capacity;
+  unsigned mask;
+  unsigned head = 0;
+  unsigned tail = 0;
+
+  void grow(int minimumCapacity);
+  static void transfer(T *to, T *from, int count);
 
 public:
-  QueueArray();
+  QueueArray(int initialCapacity = 16);
   virtual ~QueueArray();
   QueueArray(const QueueArray &other) = delete;
   QueueArray &operator=(const QueueArray &other) = delete;
   void enqueue(const T &element);
+  void enqueue_n(const T *source, int count);
   T dequeue();
+  int dequeue_n(T *destination, int maxCount);
   const T &peek() const;
   bool isEmpty() const;
   int size() const;
 };
 
-template <typename T> inline QueueArray<T>::QueueArray() {}
+template <typename T> inline QueueArray<T>::QueueArray(int initialCapacity) {
+  capacity = 1;
+  while (capacity < initialCapacity) {
+    capacity <<= 1;
+  }
+  mask = unsigned(capacity) - 1;
+  elements = std::allocator<T>().allocate(capacity);
+}
 
-template <typename T> inline QueueArray<T>::~QueueArray() {}
+template <typename T> inline QueueArray<T>::~QueueArray() {
+  for (unsigned i = head; i != tail; i++) {
+    elements[i & mask].~T();
+  }
+  std::allocator<T>().deallocate(elements, capacity);
+}
 
-template <typename T> inline void QueueArray<T>::enqueue(const T &element) {}
+// Move constructs count elements into raw storage and ends the lifetime of
+// the sources. Trivially copyable elements go through one memcpy.
+template <typename T>
+inline void QueueArray<T>::transfer(T *to, T *from, int count) {
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    if (count > 0) {
+      std::memcpy(static_cast<void *>(to), from, sizeof(T) * count);
+    }
+  } else {
+    for (int i = 0; i < count; i++) {
+      ::new (static_cast<void *>(to + i)) T(std::move_if_noexcept(from[i]));
+      from[i].~T();
+    }
+  }
+}
+
+// Unrolls the ring into the front of a larger buffer: at most two segments,
+// [head, end of storage) and [start of storage, tail).
+template <typename T> inline void QueueArray<T>::grow(int minimumCapacity) {
+  int newCapacity = capacity;
+  while (newCapacity < minimumCapacity) {
+    newCapacity <<= 1;
+  }
+  T *grown = std::allocator<T>().allocate(newCapacity);
+  int count = size();
+  int first = int(head & mask);
+  int firstCount = std::min(count, capacity - first);
+  transfer(grown, elements + first, firstCount);
+  transfer(grown + firstCount, elements, count - firstCount);
+  std::allocator<T>().deallocate(elements, capacity);
+  elements = grown;
+  capacity = newCapacity;
+  mask = unsigned(newCapacity) - 1;
+  head = 0;
+  tail = unsigned(count);
+}
+
+template <typename T> inline void QueueArray<T>::enqueue(const T &element) {
+  if (size() == capacity) {
+    T copy(element); // element may be one of ours
+    grow(capacity * 2);
+    ::new (static_cast<void *>(elements + (tail & mask))) T(std::move(copy));
+  } else {
+    ::new (static_cast<void *>(elements + (tail & mask))) T(element);
+  }
+  tail++;
+}
+
+// Copies count elements in at most two contiguous segments. source must not
+// point into this queue.
+template <typename T>
+inline void QueueArray<T>::enqueue_n(const T *source, int count) {
+  if (count <= 0) {
+    return;
+  }
+  if (size() + count > capacity) {
+    grow(size() + count);
+  }
+  int first = int(tail & mask);
+  int firstCount = std::min(count, capacity - first);
+  std::uninitialized_copy(source, source + firstCount, elements + first);
+  std::uninitialized_copy(source + firstCount, source + count, elements);
+  tail += unsigned(count);
+}
 
 template <typename T> inline T QueueArray<T>::dequeue() {
-  T removeThis;
-  return removeThis;
+  if (head == tail) {
+    throw std::out_of_range("dequeue on empty QueueArray");
+  }
+  T &front = elements[head & mask];
+  T element(std::move(front));
+  front.~T();
+  head++;
+  return element;
+}
+
+// Moves up to maxCount elements into destination, which must already hold
+// constructed objects, and returns how many were moved.
+template <typename T>
+inline int QueueArray<T>::dequeue_n(T *destination, int maxCount) {
+  int count = std::min(size(), maxCount);
+  if (count <= 0) {
+    return 0;
+  }
+  int first = int(head & mask);
+  int firstCount = std::min(count, capacity - first);
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    std::memcpy(static_cast<void *>(destination), elements + first,
+                sizeof(T) * firstCount);
+    std::memcpy(static_cast<void *>(destination + firstCount), elements,
+                sizeof(T) * (count - firstCount));
+  } else {
+    std::move(elements + first, elements + first + firstCount, destination);
+    std::move(elements, elements + count - firstCount,
+              destination + firstCount);
+    for (int i = 0; i < count; i++) {
+      elements[(head + unsigned(i)) & mask].~T();
+    }
+  }
+  head += unsigned(count);
+  return count;
 }
 
 template <typename T> inline const T &QueueArray<T>::peek() const {
-  T removeThis;
-  return removeThis;
+  if (head == tail) {
+    throw std::out_of_range("peek on empty QueueArray");
+  }
+  return elements[head & mask];
 }
 
 template <typename T> inline bool QueueArray<T>::isEmpty() const {
-  return false;
+  return head == tail;
 }
 
-template <typename T> inline int QueueArray<T>::size() const { return -1; }
+template <typename T> inline int QueueArray<T>::size() const {
+  return int(tail - head);
+}
 
 #endif
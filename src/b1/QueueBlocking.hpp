@@ -0,0 +1,174 @@
+#ifndef QUEUEBLOCKING_H
+#define QUEUEBLOCKING_H
+#include "QueueArray.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// Unbounded multi producer/multi consumer queue with blocking pops, built on
+// QueueArray behind a mutex. A consumer that finds the queue empty first
+// spins for a little while on an atomic count of available elements (cheap
+// when the producer is only a few hundred nanoseconds behind) and then parks
+// on a condition variable. Producers keep track of parked consumers and only
+// pay for notify when there is one. close() releases every waiter.
+template <typename T> class QueueBlocking {
+private:
+  static const int SpinLimit = 256;
+
+  QueueArray<T> queue;
+  mutable std::mutex lock;
+  std::condition_variable nonEmpty;
+  std::atomic<int> available{0}; // queue.size(), readable without the lock
+  int waiters = 0;               // Guarded by lock
+  bool closed = false;           // Guarded by lock
+
+  bool spinUntilAvailable() const;
+
+public:
+  QueueBlocking(int initialCapacity = 16);
+  virtual ~QueueBlocking() = default;
+  QueueBlocking(const QueueBlocking &other) = delete;
+  QueueBlocking &operator=(const QueueBlocking &other) = delete;
+
+  void push(const T &element);
+  void push_n(const T *source, int count);
+  bool tryPop(T &element);
+
+  // Blocks until an element arrives. Throws std::out_of_range once the queue
+  // is closed and drained.
+  T pop_wait();
+
+  // Blocks until at least one element is available or timeout passes, then
+  // moves up to maxCount elements into destination (which must hold
+  // constructed objects). Returns how many were moved, 0 on timeout or when
+  // the queue is closed and drained.
+  template <typename Rep, typename Period>
+  int pop_batch_wait(T *destination, int maxCount,
+                     std::chrono::duration<Rep, Period> timeout);
+
+  void close();
+  bool isEmpty() const;
+  int size() const;
+};
+
+template <typename T>
+inline QueueBlocking<T>::QueueBlocking(int initialCapacity)
+    : queue(initialCapacity) {}
+
+template <typename T>
+inline bool QueueBlocking<T>::spinUntilAvailable() const {
+  for (int i = 0; i < SpinLimit; i++) {
+    if (available.load(std::memory_order_acquire) > 0) {
+      return true;
+    }
+    if (i % 64 == 63) {
+      std::this_thread::yield();
+    }
+  }
+  return false;
+}
+
+template <typename T> inline void QueueBlocking<T>::push(const T &element) {
+  bool wake;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    queue.enqueue(element);
+    available.fetch_add(1, std::memory_order_release);
+    wake = waiters > 0;
+  }
+  if (wake) {
+    nonEmpty.notify_one();
+  }
+}
+
+template <typename T>
+inline void QueueBlocking<T>::push_n(const T *source, int count) {
+  if (count <= 0) {
+    return;
+  }
+  int parked;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    queue.enqueue_n(source, count);
+    available.fetch_add(count, std::memory_order_release);
+    parked = waiters;
+  }
+  if (parked > 0) {
+    if (parked == 1 || count == 1) {
+      nonEmpty.notify_one();
+    } else {
+      nonEmpty.notify_all();
+    }
+  }
+}
+
+template <typename T> inline bool QueueBlocking<T>::tryPop(T &element) {
+  if (available.load(std::memory_order_acquire) == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  if (queue.isEmpty()) {
+    return false;
+  }
+  element = queue.dequeue();
+  available.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+template <typename T> inline T QueueBlocking<T>::pop_wait() {
+  spinUntilAvailable();
+  std::unique_lock<std::mutex> guard(lock);
+  if (queue.isEmpty() && !closed) {
+    waiters++;
+    nonEmpty.wait(guard, [this] { return !queue.isEmpty() || closed; });
+    waiters--;
+  }
+  if (queue.isEmpty()) {
+    throw std::out_of_range("pop_wait on closed QueueBlocking");
+  }
+  available.fetch_sub(1, std::memory_order_relaxed);
+  return queue.dequeue();
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+inline int
+QueueBlocking<T>::pop_batch_wait(T *destination, int maxCount,
+                                 std::chrono::duration<Rep, Period> timeout) {
+  if (maxCount <= 0) {
+    return 0;
+  }
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  spinUntilAvailable();
+  std::unique_lock<std::mutex> guard(lock);
+  if (queue.isEmpty() && !closed) {
+    waiters++;
+    nonEmpty.wait_until(guard, deadline,
+                        [this] { return !queue.isEmpty() || closed; });
+    waiters--;
+  }
+  int count = queue.dequeue_n(destination, maxCount);
+  available.fetch_sub(count, std::memory_order_relaxed);
+  return count;
+}
+
+template <typename T> inline void QueueBlocking<T>::close() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    closed = true;
+  }
+  nonEmpty.notify_all();
+}
+
+template <typename T> inline bool QueueBlocking<T>::isEmpty() const {
+  return size() == 0;
+}
+
+template <typename T> inline int QueueBlocking<T>::size() const {
+  return available.load(std::memory_order_acquire);
+}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef QUEUECHUNKED_H
+#define QUEUECHUNKED_H
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Unrolled linked list queue: elements are stored in fixed size, cache line
+// aligned chunks that are linked together, so a pointer is followed once per
+// chunk instead of once per element and the per element overhead is gone.
+// The front chunk is recycled when it empties instead of going back to the
+// heap. Same interface as QueueLinkedList.
+template <typename T> class QueueChunked {
+private:
+  static const int CacheLine = 64;
+  static const int ChunkBytes = 512;
+  static const int ChunkCapacity =
+      (ChunkBytes - int(sizeof(void *))) / int(sizeof(T)) > 8
+          ? (ChunkBytes - int(sizeof(void *))) / int(sizeof(T))
+          : 8;
+
+  struct alignas(CacheLine) Chunk {
+    Chunk *next = nullptr;
+    alignas(T) unsigned char storage[sizeof(T) * ChunkCapacity];
+    T *at(int index) { return reinterpret_cast<T *>(storage) + index; }
+  };
+
+  Chunk *front = nullptr;
+  Chunk *back = nullptr;
+  Chunk *spare = nullptr; // One emptied chunk kept for the next enqueue
+  int frontIndex = 0;     // Next element to dequeue in front
+  int backIndex = 0;      // Next free slot in back
+  int amount = 0;
+  int chunks = 0; // Allocated, including the spare
+
+  Chunk *newChunk();
+
+public:
+  QueueChunked();
+  virtual ~QueueChunked();
+  QueueChunked(const QueueChunked &other) = delete;
+  QueueChunked &operator=(const QueueChunked &other) = delete;
+  void enqueue(const T &element);
+  T dequeue();
+  const T &peek() const;
+  bool isEmpty() const;
+  int size() const;
+  size_t bytesReserved() const;
+};
+
+template <typename T> inline QueueChunked<T>::QueueChunked() {}
+
+template <typename T> inline QueueChunked<T>::~QueueChunked() {
+  while (amount > 0) {
+    dequeue();
+  }
+  delete front;
+  delete spare;
+}
+
+template <typename T>
+inline typename QueueChunked<T>::Chunk *QueueChunked<T>::newChunk() {
+  if (spare != nullptr) {
+    Chunk *chunk = spare;
+    spare = nullptr;
+    chunk->next = nullptr;
+    return chunk;
+  }
+  chunks++;
+  return new Chunk();
+}
+
+template <typename T> inline void QueueChunked<T>::enqueue(const T &element) {
+  if (back == nullptr) {
+    front = back = newChunk();
+    frontIndex = backIndex = 0;
+  } else if (backIndex == ChunkCapacity) {
+    Chunk *chunk = newChunk();
+    back->next = chunk;
+    back = chunk;
+    backIndex = 0;
+  }
+  ::new (static_cast<void *>(back->at(backIndex))) T(element);
+  backIndex++;
+  amount++;
+}
+
+template <typename T> inline T QueueChunked<T>::dequeue() {
+  if (amount == 0) {
+    throw std::out_of_range("dequeue on empty QueueChunked");
+  }
+  T *slot = front->at(frontIndex);
+  T element(std::move(*slot));
+  slot->~T();
+  frontIndex++;
+  amount--;
+  if (amount == 0) {
+    // Single chunk left and now empty: rewind it instead of unlinking.
+    frontIndex = backIndex = 0;
+  } else if (frontIndex == ChunkCapacity) {
+    Chunk *emptied = front;
+    front = front->next;
+    frontIndex = 0;
+    if (spare == nullptr) {
+      spare = emptied;
+    } else {
+      delete emptied;
+      chunks--;
+    }
+  }
+  return element;
+}
+
+template <typename T> inline const T &QueueChunked<T>::peek() const {
+  if (amount == 0) {
+    throw std::out_of_range("peek on empty QueueChunked");
+  }
+  return *front->at(frontIndex);
+}
+
+template <typename T> inline bool QueueChunked<T>::isEmpty() const {
+  return amount == 0;
+}
+
+template <typename T> inline int QueueChunked<T>::size() const {
+  return amount;
+}
+
+template <typename T> inline size_t QueueChunked<T>::bytesReserved() const {
+  return size_t(chunks) * sizeof(Chunk);
+}
+
+#endif
@@ -1,16 +1,24 @@
 
 #ifndef QUEUELINKEDLIST_H
 #define QUEUELINKEDLIST_H
+#include "PoolAllocator.hpp"
 #include <stdexcept>
+#include <utility>
 
-template <typename T> class QueueLinkedList {
+template <typename T,
+          template <typename> class NodeAllocator = NewDeleteAllocator>
+class QueueLinkedList {
 private:
   class Node {
   public:
     T data;
     Node *next;
-    Node(T data, Node *next = nullptr) : data(data), next(next) {}
+    Node(const T &data, Node *next = nullptr) : data(data), next(next) {}
   };
+  Node *front = nullptr;
+  Node *back = nullptr;
+  int amount = 0;
+  NodeAllocator<Node> allocator;
 
 public:
   QueueLinkedList();
@@ -22,29 +30,71 @@ public:
   const T &peek() const;
   bool isEmpty() const;
   int size() const;
+  size_t bytesReserved() const;
 };
 
-template <typename T> inline QueueLinkedList<T>::QueueLinkedList() {}
+template <typename T, template <typename> class NodeAllocator>
+inline QueueLinkedList<T, NodeAllocator>::QueueLinkedList() {}
 
-template <typename T> inline QueueLinkedList<T>::~QueueLinkedList() {}
+template <typename T, template <typename> class NodeAllocator>
+inline QueueLinkedList<T, NodeAllocator>::~QueueLinkedList() {
+  while (front != nullptr) {
+    Node *next = front->next;
+    allocator.destroy(front);
+    front = next;
+  }
+}
 
-template <typename T>
-inline void QueueLinkedList<T>::enqueue(const T &element) {}
+template <typename T, template <typename> class NodeAllocator>
+inline void QueueLinkedList<T, NodeAllocator>::enqueue(const T &element) {
+  Node *node = allocator.create(element);
+  if (back == nullptr) {
+    front = node;
+  } else {
+    back->next = node;
+  }
+  back = node;
+  amount++;
+}
 
-template <typename T> inline T QueueLinkedList<T>::dequeue() {
-  T removeThis;
-  return removeThis;
+template <typename T, template <typename> class NodeAllocator>
+inline T QueueLinkedList<T, NodeAllocator>::dequeue() {
+  if (front == nullptr) {
+    throw std::out_of_range("dequeue on empty QueueLinkedList");
+  }
+  Node *removed = front;
+  T data = std::move(removed->data);
+  front = removed->next;
+  if (front == nullptr) {
+    back = nullptr;
+  }
+  allocator.destroy(removed);
+  amount--;
+  return data;
 }
 
-template <typename T> inline const T &QueueLinkedList<T>::peek() const {
-  T removeThis;
-  return removeThis;
+template <typename T, template <typename> class NodeAllocator>
+inline const T &QueueLinkedList<T, NodeAllocator>::peek() const {
+  if (front == nullptr) {
+    throw std::out_of_range("peek on empty QueueLinkedList");
+  }
+  return front->data;
 }
 
-template <typename T> inline bool QueueLinkedList<T>::isEmpty() const {
-  return false;
+template <typename T, template <typename> class NodeAllocator>
+inline bool QueueLinkedList<T, NodeAllocator>::isEmpty() const {
+  return front == nullptr;
 }
 
-template <typename T> inline int QueueLinkedList<T>::size() const { return -1; }
+template <typename T, template <typename> class NodeAllocator>
+inline int QueueLinkedList<T, NodeAllocator>::size() const {
+  return amount;
+}
+
+// Bytes the node allocator holds, 0 when nodes come straight from the heap.
+template <typename T, template <typename> class NodeAllocator>
+inline size_t QueueLinkedList<T, NodeAllocator>::bytesReserved() const {
+  return allocator.bytesReserved();
+}
 
 #endif
@@ -0,0 +1,153 @@
+#ifndef QUEUEMPMC_H
+#define QUEUEMPMC_H
+#include <atomic>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Bounded lock-free queue for any number of producer and consumer threads
+// (Dmitry Vyukov's design). Every slot carries a sequence number that says
+// whose turn it is: a slot at position p is free for the producer claiming p
+// when sequence == p, and holds data for the consumer claiming p when
+// sequence == p + 1. Producers and consumers claim positions with a CAS on
+// their own counter and then hand the slot over with a release store of the
+// next sequence number, so the only contended lines are the two counters.
+template <typename T> class QueueMPMC {
+private:
+  static const int CacheLine = 64;
+
+  struct Slot {
+    std::atomic<unsigned> sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+    T *data() { return reinterpret_cast<T *>(storage); }
+  };
+
+  Slot *slots;
+  int capacity;
+  unsigned mask;
+
+  alignas(CacheLine) std::atomic<unsigned> enqueuePosition{0};
+  alignas(CacheLine) std::atomic<unsigned> dequeuePosition{0};
+  alignas(CacheLine) char padding = 0;
+
+public:
+  QueueMPMC(int minimumCapacity = 1024);
+  virtual ~QueueMPMC();
+  QueueMPMC(const QueueMPMC &other) = delete;
+  QueueMPMC &operator=(const QueueMPMC &other) = delete;
+
+  bool tryEnqueue(const T &element);
+  bool tryDequeue(T &element);
+
+  // Blocking forms: spin, then yield, until there is room or an element.
+  void enqueue(const T &element);
+  T dequeue();
+
+  // Snapshot only while other threads are active.
+  bool isEmpty() const;
+  int size() const;
+  int getCapacity() const;
+};
+
+template <typename T> inline QueueMPMC<T>::QueueMPMC(int minimumCapacity) {
+  if (minimumCapacity < 2) {
+    throw std::invalid_argument("QueueMPMC capacity must be at least 2");
+  }
+  capacity = 1;
+  while (capacity < minimumCapacity) {
+    capacity <<= 1;
+  }
+  mask = unsigned(capacity) - 1;
+  slots = new Slot[capacity];
+  for (int i = 0; i < capacity; i++) {
+    slots[i].sequence.store(unsigned(i), std::memory_order_relaxed);
+  }
+}
+
+template <typename T> inline QueueMPMC<T>::~QueueMPMC() {
+  T element;
+  while (tryDequeue(element)) {
+  }
+  delete[] slots;
+}
+
+template <typename T>
+inline bool QueueMPMC<T>::tryEnqueue(const T &element) {
+  unsigned position = enqueuePosition.load(std::memory_order_relaxed);
+  while (true) {
+    Slot &slot = slots[position & mask];
+    unsigned sequence = slot.sequence.load(std::memory_order_acquire);
+    int difference = int(sequence - position);
+    if (difference == 0) {
+      if (enqueuePosition.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+        ::new (static_cast<void *>(slot.storage)) T(element);
+        slot.sequence.store(position + 1, std::memory_order_release);
+        return true;
+      }
+      // A failed CAS reloaded position; retry with it.
+    } else if (difference < 0) {
+      return false; // The slot still holds data from a lap ago: full.
+    } else {
+      position = enqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T> inline bool QueueMPMC<T>::tryDequeue(T &element) {
+  unsigned position = dequeuePosition.load(std::memory_order_relaxed);
+  while (true) {
+    Slot &slot = slots[position & mask];
+    unsigned sequence = slot.sequence.load(std::memory_order_acquire);
+    int difference = int(sequence - (position + 1));
+    if (difference == 0) {
+      if (dequeuePosition.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+        T *data = slot.data();
+        element = std::move(*data);
+        data->~T();
+        slot.sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (difference < 0) {
+      return false; // Nothing published at this position yet: empty.
+    } else {
+      position = dequeuePosition.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T> inline void QueueMPMC<T>::enqueue(const T &element) {
+  for (int spins = 0; !tryEnqueue(element); spins++) {
+    if (spins > 64) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+template <typename T> inline T QueueMPMC<T>::dequeue() {
+  T element;
+  for (int spins = 0; !tryDequeue(element); spins++) {
+    if (spins > 64) {
+      std::this_thread::yield();
+    }
+  }
+  return element;
+}
+
+template <typename T> inline bool QueueMPMC<T>::isEmpty() const {
+  return size() == 0;
+}
+
+template <typename T> inline int QueueMPMC<T>::size() const {
+  unsigned front = dequeuePosition.load(std::memory_order_acquire);
+  int amount = int(enqueuePosition.load(std::memory_order_acquire) - front);
+  return amount < 0 ? 0 : (amount > capacity ? capacity : amount);
+}
+
+template <typename T> inline int QueueMPMC<T>::getCapacity() const {
+  return capacity;
+}
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef QUEUESPSC_H
+#define QUEUESPSC_H
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Bounded lock-free ring queue for exactly one producer thread and one
+// consumer thread. Same power-of-two masking as QueueArray, but head is only
+// written by the consumer and tail only by the producer, each published with a
+// release store and read with an acquire load. The two indices sit on separate
+// cache lines, and each side keeps a plain cached copy of the other side's
+// index so it only touches the shared line when the cached value says the
+// queue looks full (producer) or empty (consumer).
+template <typename T> class QueueSPSC {
+private:
+  static const int CacheLine = 64;
+
+  T *elements;
+  int capacity;
+  unsigned mask;
+
+  alignas(CacheLine) std::atomic<unsigned> head{0}; // Written by the consumer
+  unsigned cachedTail = 0;                          // Consumer's view of tail
+
+  alignas(CacheLine) std::atomic<unsigned> tail{0}; // Written by the producer
+  unsigned cachedHead = 0;                          // Producer's view of head
+
+  alignas(CacheLine) char padding = 0; // Keeps tail off the next object's line
+
+public:
+  QueueSPSC(int minimumCapacity = 1024);
+  virtual ~QueueSPSC();
+  QueueSPSC(const QueueSPSC &other) = delete;
+  QueueSPSC &operator=(const QueueSPSC &other) = delete;
+
+  // Producer side.
+  bool tryEnqueue(const T &element);
+  int enqueue_n(const T *source, int count);
+
+  // Consumer side.
+  bool tryDequeue(T &element);
+  int dequeue_n(T *destination, int maxCount);
+
+  // Exact when called from either side with the other one idle, otherwise a
+  // snapshot that may already be stale.
+  bool isEmpty() const;
+  int size() const;
+  int getCapacity() const;
+};
+
+template <typename T> inline QueueSPSC<T>::QueueSPSC(int minimumCapacity) {
+  if (minimumCapacity < 1) {
+    throw std::invalid_argument("QueueSPSC capacity must be positive");
+  }
+  capacity = 1;
+  while (capacity < minimumCapacity) {
+    capacity <<= 1;
+  }
+  mask = unsigned(capacity) - 1;
+  elements = std::allocator<T>().allocate(capacity);
+}
+
+template <typename T> inline QueueSPSC<T>::~QueueSPSC() {
+  unsigned end = tail.load(std::memory_order_acquire);
+  for (unsigned i = head.load(std::memory_order_relaxed); i != end; i++) {
+    elements[i & mask].~T();
+  }
+  std::allocator<T>().deallocate(elements, capacity);
+}
+
+template <typename T>
+inline bool QueueSPSC<T>::tryEnqueue(const T &element) {
+  unsigned position = tail.load(std::memory_order_relaxed);
+  if (position - cachedHead == unsigned(capacity)) {
+    cachedHead = head.load(std::memory_order_acquire);
+    if (position - cachedHead == unsigned(capacity)) {
+      return false;
+    }
+  }
+  ::new (static_cast<void *>(elements + (position & mask))) T(element);
+  tail.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+// Enqueues as many of the count elements as fit and publishes them with a
+// single release store. Returns how many were enqueued.
+template <typename T>
+inline int QueueSPSC<T>::enqueue_n(const T *source, int count) {
+  unsigned position = tail.load(std::memory_order_relaxed);
+  unsigned space = unsigned(capacity) - (position - cachedHead);
+  if (space < unsigned(count)) {
+    cachedHead = head.load(std::memory_order_acquire);
+    space = unsigned(capacity) - (position - cachedHead);
+  }
+  int n = std::min(count, int(space));
+  for (int i = 0; i < n; i++) {
+    ::new (static_cast<void *>(elements + ((position + unsigned(i)) & mask)))
+        T(source[i]);
+  }
+  if (n > 0) {
+    tail.store(position + unsigned(n), std::memory_order_release);
+  }
+  return n;
+}
+
+template <typename T> inline bool QueueSPSC<T>::tryDequeue(T &element) {
+  unsigned position = head.load(std::memory_order_relaxed);
+  if (position == cachedTail) {
+    cachedTail = tail.load(std::memory_order_acquire);
+    if (position == cachedTail) {
+      return false;
+    }
+  }
+  T &slot = elements[position & mask];
+  element = std::move(slot);
+  slot.~T();
+  head.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+inline int QueueSPSC<T>::dequeue_n(T *destination, int maxCount) {
+  unsigned position = head.load(std::memory_order_relaxed);
+  unsigned available = cachedTail - position;
+  if (available < unsigned(maxCount)) {
+    cachedTail = tail.load(std::memory_order_acquire);
+    available = cachedTail - position;
+  }
+  int n = std::min(maxCount, int(available));
+  for (int i = 0; i < n; i++) {
+    T &slot = elements[(position + unsigned(i)) & mask];
+    destination[i] = std::move(slot);
+    slot.~T();
+  }
+  if (n > 0) {
+    head.store(position + unsigned(n), std::memory_order_release);
+  }
+  return n;
+}
+
+template <typename T> inline bool QueueSPSC<T>::isEmpty() const {
+  return size() == 0;
+}
+
+template <typename T> inline int QueueSPSC<T>::size() const {
+  unsigned front = head.load(std::memory_order_acquire);
+  return int(tail.load(std::memory_order_acquire) - front);
+}
+
+template <typename T> inline int QueueSPSC<T>::getCapacity() const {
+  return capacity;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef SMALLSTACK_H
+#define SMALLSTACK_H
+#include "StackArray.hpp"
+#include <memory>
+
+// StackArray storage with room for N elements inside the object itself, so
+// a stack that never holds more than N elements never touches the heap. The
+// first push past N spills everything to a heap buffer of 2N, which then
+// doubles like StackArray; a shrinking stack moves back in once it fits.
+template <typename T, int N> class InlineStorage {
+  static_assert(N > 0, "InlineStorage needs room for at least one element");
+
+private:
+  alignas(T) unsigned char buffer[sizeof(T) * N];
+  bool inUse = false;
+
+  T *inlineBuffer() { return reinterpret_cast<T *>(buffer); }
+
+public:
+  static const int defaultCapacity = N;
+
+  InlineStorage() = default;
+  InlineStorage(const InlineStorage &other) = delete;
+  InlineStorage &operator=(const InlineStorage &other) = delete;
+
+  T *allocate(int capacity) {
+    if (!inUse && capacity <= N) {
+      inUse = true;
+      return inlineBuffer();
+    }
+    return std::allocator<T>().allocate(capacity);
+  }
+  void deallocate(T *elements, int capacity) {
+    if (elements == inlineBuffer()) {
+      inUse = false;
+    } else {
+      std::allocator<T>().deallocate(elements, capacity);
+    }
+  }
+};
+
+template <typename T, int N = 16>
+using SmallStack = StackArray<T, InlineStorage<T, N>>;
+
+#endif
@@ -1,52 +1,173 @@
 #ifndef STACKARRAY_H
 #define STACKARRAY_H
+#include <cstring>
+#include <memory>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
-template <typename T> class StackArray {
+// Array backed stack that doubles its capacity when full. Elements live in raw
+// storage so only pushed elements are constructed; on growth they are
+// relocated by memcpy for trivially copyable T and by move otherwise.
+// With shrinkWhenSparse the capacity is halved once the stack drops to a
+// quarter full, never below the initial capacity. The gap between the grow and
+// shrink points keeps a push/pop pattern at the boundary from reallocating
+// every time.
+//
+// Storage hands out the element buffers: allocate(capacity) and
+// deallocate(buffer, capacity), plus defaultCapacity for a stack constructed
+// without one. HeapStorage takes every buffer from std::allocator.
+template <typename T> class HeapStorage {
+public:
+  static const int defaultCapacity = 10;
+  T *allocate(int capacity) { return std::allocator<T>().allocate(capacity); }
+  void deallocate(T *buffer, int capacity) {
+    std::allocator<T>().deallocate(buffer, capacity);
+  }
+};
+
+template <typename T, typename Storage = HeapStorage<T>> class StackArray {
 private:
+  Storage storage;
   T *elements;
   int capacity;
   int amount = 0;
+  int minimumCapacity;
+  bool shrinkWhenSparse;
+
+  void relocate(int newCapacity);
 
 public:
-  StackArray(int initialCapacity = 10);
+  StackArray(int initialCapacity = Storage::defaultCapacity,
+             bool shrinkWhenSparse = false);
   virtual ~StackArray();
   StackArray(const StackArray &other) = delete;
   StackArray &operator=(const StackArray &other) = delete;
   void push(const T &element);
+  void push(T &&element);
+  template <typename... Args> T &emplace(Args &&...args);
   T pop();
   const T &peek() const;
   bool isEmpty() const;
   int size() const;
+  int getCapacity() const;
+  void reserve(int newCapacity);
+  void shrinkToFit();
 };
 
-template <typename T> inline StackArray<T>::StackArray(int initialCapacity) {
-  elements = new T[initialCapacity];
-  capacity = initialCapacity;
+template <typename T, typename Storage>
+inline StackArray<T, Storage>::StackArray(int initialCapacity,
+                                          bool shrinkWhenSparse)
+    : capacity(initialCapacity < 1 ? 1 : initialCapacity),
+      minimumCapacity(initialCapacity < 1 ? 1 : initialCapacity),
+      shrinkWhenSparse(shrinkWhenSparse) {
+  elements = storage.allocate(capacity);
+}
+
+template <typename T, typename Storage>
+inline StackArray<T, Storage>::~StackArray() {
+  for (int i = 0; i < amount; i++) {
+    elements[i].~T();
+  }
+  storage.deallocate(elements, capacity);
 }
 
-template <typename T> inline StackArray<T>::~StackArray() { delete[] elements; }
+template <typename T, typename Storage>
+inline void StackArray<T, Storage>::relocate(int newCapacity) {
+  T *relocated = storage.allocate(newCapacity);
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    if (amount > 0) {
+      std::memcpy(static_cast<void *>(relocated), elements,
+                  sizeof(T) * amount);
+    }
+  } else {
+    for (int i = 0; i < amount; i++) {
+      ::new (static_cast<void *>(relocated + i))
+          T(std::move_if_noexcept(elements[i]));
+      elements[i].~T();
+    }
+  }
+  storage.deallocate(elements, capacity);
+  elements = relocated;
+  capacity = newCapacity;
+}
 
-template <typename T> inline void StackArray<T>::push(const T &element) {
-  amount = (amount++) % capacity;
-  elements[amount] = element;
+template <typename T, typename Storage>
+inline void StackArray<T, Storage>::reserve(int newCapacity) {
+  if (newCapacity > capacity) {
+    relocate(newCapacity);
+  }
 }
-template <typename T> inline expand();
-template <typename T> inline T StackArray<T>::pop() {
-  T element = elements[amount];
+
+template <typename T, typename Storage>
+inline void StackArray<T, Storage>::shrinkToFit() {
+  int fitted = amount < minimumCapacity ? minimumCapacity : amount;
+  if (fitted < capacity) {
+    relocate(fitted);
+  }
+}
+
+template <typename T, typename Storage>
+template <typename... Args>
+inline T &StackArray<T, Storage>::emplace(Args &&...args) {
+  if (amount == capacity) {
+    // The arguments may refer into this stack, so build the element before
+    // the old storage goes away.
+    T element(std::forward<Args>(args)...);
+    relocate(capacity * 2);
+    ::new (static_cast<void *>(elements + amount)) T(std::move(element));
+  } else {
+    ::new (static_cast<void *>(elements + amount))
+        T(std::forward<Args>(args)...);
+  }
+  return elements[amount++];
+}
+
+template <typename T, typename Storage>
+inline void StackArray<T, Storage>::push(const T &element) {
+  emplace(element);
+}
+
+template <typename T, typename Storage>
+inline void StackArray<T, Storage>::push(T &&element) {
+  emplace(std::move(element));
+}
+
+template <typename T, typename Storage>
+inline T StackArray<T, Storage>::pop() {
+  if (amount == 0) {
+    throw std::out_of_range("pop on empty StackArray");
+  }
   amount--;
+  T element(std::move(elements[amount]));
+  elements[amount].~T();
+  if (shrinkWhenSparse && amount <= capacity / 4 &&
+      capacity / 2 >= minimumCapacity) {
+    relocate(capacity / 2);
+  }
   return element;
 }
 
-template <typename T> inline const T &StackArray<T>::peek() const {
-  T &element = &elements[amount];
-  return element;
+template <typename T, typename Storage>
+inline const T &StackArray<T, Storage>::peek() const {
+  if (amount == 0) {
+    throw std::out_of_range("peek on empty StackArray");
+  }
+  return elements[amount - 1];
 }
 
-template <typename T> inline bool StackArray<T>::isEmpty() const {
+template <typename T, typename Storage>
+inline bool StackArray<T, Storage>::isEmpty() const {
   return amount == 0;
 }
 
-template <typename T> inline int StackArray<T>::size() const { return amount; }
+template <typename T, typename Storage>
+inline int StackArray<T, Storage>::size() const { return amount; }
+
+template <typename T, typename Storage>
+inline int StackArray<T, Storage>::getCapacity() const {
+  return capacity;
+}
 
 #endif
@@ -1,16 +1,21 @@
 #ifndef STACKLINKEDLIST_H
 #define STACKLINKEDLIST_H
+#include "PoolAllocator.hpp"
 #include <stdexcept>
+#include <utility>
 
-template <typename T> class StackLinkedList {
+template <typename T,
+          template <typename> class NodeAllocator = NewDeleteAllocator>
+class StackLinkedList {
 private:
   class Node {
   public:
     T data;
     Node *next;
-    Node(T data, Node *next = nullptr) : data(data), next(next) {}
+    Node(const T &data, Node *next = nullptr) : data(data), next(next) {}
   };
   Node *start;
+  NodeAllocator<Node> allocator;
 
 public:
   StackLinkedList();
@@ -22,38 +27,53 @@ public:
   const T &peek() const;
   bool isEmpty() const;
   int size() const;
+  size_t bytesReserved() const;
 };
 
-template <typename T> inline StackLinkedList<T>::StackLinkedList() {}
+template <typename T, template <typename> class NodeAllocator>
+inline StackLinkedList<T, NodeAllocator>::StackLinkedList() : start(nullptr) {}
 
-template <typename T> inline StackLinkedList<T>::~StackLinkedList() {}
+template <typename T, template <typename> class NodeAllocator>
+inline StackLinkedList<T, NodeAllocator>::~StackLinkedList() {
+  while (start != nullptr) {
+    Node *next = start->next;
+    allocator.destroy(start);
+    start = next;
+  }
+}
 
-template <typename T> inline void StackLinkedList<T>::push(const T &element) {
-  start = Node(element, start);
+template <typename T, template <typename> class NodeAllocator>
+inline void StackLinkedList<T, NodeAllocator>::push(const T &element) {
+  start = allocator.create(element, start);
 }
 
-template <typename T> inline T StackLinkedList<T>::pop() {
+template <typename T, template <typename> class NodeAllocator>
+inline T StackLinkedList<T, NodeAllocator>::pop() {
   if (start == nullptr) {
-    return nullptr;
+    throw std::out_of_range("pop on empty StackLinkedList");
   }
-  T data = start->data;
-  start = start->next;
+  Node *popped = start;
+  T data = std::move(popped->data);
+  start = popped->next;
+  allocator.destroy(popped);
   return data;
 }
 
-template <typename T> inline const T &StackLinkedList<T>::peek() const {
-
+template <typename T, template <typename> class NodeAllocator>
+inline const T &StackLinkedList<T, NodeAllocator>::peek() const {
   if (start == nullptr) {
-    return nullptr;
+    throw std::out_of_range("peek on empty StackLinkedList");
   }
-  return &start->data;
+  return start->data;
 }
 
-template <typename T> inline bool StackLinkedList<T>::isEmpty() const {
+template <typename T, template <typename> class NodeAllocator>
+inline bool StackLinkedList<T, NodeAllocator>::isEmpty() const {
   return start == nullptr;
 }
 
-template <typename T> inline int StackLinkedList<T>::size() const {
+template <typename T, template <typename> class NodeAllocator>
+inline int StackLinkedList<T, NodeAllocator>::size() const {
   Node *next = start;
   int size = 0;
   while (next != nullptr) {
@@ -63,4 +83,10 @@ template <typename T> inline int StackLinkedList<T>::size() const {
   return size;
 }
 
+// Bytes the node allocator holds, 0 when nodes come straight from the heap.
+template <typename T, template <typename> class NodeAllocator>
+inline size_t StackLinkedList<T, NodeAllocator>::bytesReserved() const {
+  return allocator.bytesReserved();
+}
+
 #endif
@@ -0,0 +1,85 @@
+#ifndef STACKLOCKFREE_H
+#define STACKLOCKFREE_H
+#include "HazardPointers.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+// Concurrent version of StackLinkedList (Treiber stack): push and pop swing
+// the start pointer with a CAS. pop protects the node it is about to unlink
+// with a hazard pointer, which keeps node->next readable and means the node
+// cannot be freed and reused behind our back (no ABA). Popped nodes are
+// retired to HazardPointers rather than deleted.
+template <typename T> class StackLockFree {
+private:
+  class Node {
+  public:
+    T data;
+    Node *next;
+    Node(const T &data, Node *next = nullptr) : data(data), next(next) {}
+  };
+  std::atomic<Node *> start{nullptr};
+
+public:
+  StackLockFree() = default;
+  virtual ~StackLockFree();
+  StackLockFree(const StackLockFree &other) = delete;
+  StackLockFree &operator=(const StackLockFree &other) = delete;
+  void push(const T &element);
+  bool tryPop(T &element);
+  T pop();
+  bool isEmpty() const;
+};
+
+// Must not run concurrently with other operations on this stack.
+template <typename T> inline StackLockFree<T>::~StackLockFree() {
+  Node *node = start.load(std::memory_order_acquire);
+  while (node != nullptr) {
+    Node *next = node->next;
+    delete node;
+    node = next;
+  }
+}
+
+template <typename T> inline void StackLockFree<T>::push(const T &element) {
+  Node *node = new Node(element, start.load(std::memory_order_relaxed));
+  while (!start.compare_exchange_weak(node->next, node,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+  }
+}
+
+template <typename T> inline bool StackLockFree<T>::tryPop(T &element) {
+  HazardPointers &hazards = HazardPointers::get_instance();
+  Node *node;
+  while (true) {
+    node = hazards.protect(start);
+    if (node == nullptr) {
+      hazards.clear();
+      return false;
+    }
+    if (start.compare_exchange_strong(node, node->next,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  hazards.clear();
+  element = std::move(node->data);
+  hazards.retire(node);
+  return true;
+}
+
+template <typename T> inline T StackLockFree<T>::pop() {
+  T element;
+  if (!tryPop(element)) {
+    throw std::out_of_range("pop on empty StackLockFree");
+  }
+  return element;
+}
+
+template <typename T> inline bool StackLockFree<T>::isEmpty() const {
+  return start.load(std::memory_order_acquire) == nullptr;
+}
+
+#endif
@@ -1 +1,861 @@
-int main() { return 0; }
+#include "../a2/a2.h"
+#include "DequeWorkStealing.hpp"
+#include "PoolAllocator.hpp"
+#include "QueueArray.hpp"
+#include "QueueBlocking.hpp"
+#include "QueueChunked.hpp"
+#include "QueueLinkedList.hpp"
+#include "QueueMPMC.hpp"
+#include "QueueSPSC.hpp"
+#include "SmallStack.hpp"
+#include "StackArray.hpp"
+#include "StackLinkedList.hpp"
+#include "StackLockFree.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <include/benchmark.hpp>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+using testing_benchmark::best_of_ns;
+using testing_benchmark::Clock;
+using testing_benchmark::keep;
+using testing_benchmark::print_benchmark_header;
+using testing_benchmark::print_benchmark_row;
+using testing_benchmark::print_latency_header;
+using testing_benchmark::print_latency_row;
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+#include <malloc.h>
+// Heap bytes handed out by malloc, including blocks served by mmap.
+long long heap_bytes_in_use() {
+  struct mallinfo2 info = mallinfo2();
+  return (long long)(info.uordblks + info.hblkhd);
+}
+#else
+long long heap_bytes_in_use() { return -1; }
+#endif
+
+const int Repetitions = 5;
+
+// Fills a stack to n elements and drains it again, like a DFS work list.
+void bench_stack_array() {
+  const int n = 1 << 20;
+  print_benchmark_header("StackArray push/pop vs std::vector (n = " +
+                         std::to_string(n) + ")");
+
+  double ns = best_of_ns(Repetitions, [&] {
+    StackArray<int> stack;
+    for (int i = 0; i < n; i++) {
+      stack.push(i);
+    }
+    while (!stack.isEmpty()) {
+      keep(stack.pop());
+    }
+  });
+  print_benchmark_row("StackArray<int>", ns, 2LL * n);
+
+  ns = best_of_ns(Repetitions, [&] {
+    StackArray<int> stack(16, true);
+    for (int i = 0; i < n; i++) {
+      stack.push(i);
+    }
+    while (!stack.isEmpty()) {
+      keep(stack.pop());
+    }
+  });
+  print_benchmark_row("StackArray<int> (shrinking)", ns, 2LL * n);
+
+  ns = best_of_ns(Repetitions, [&] {
+    StackArray<int> stack;
+    stack.reserve(n);
+    for (int i = 0; i < n; i++) {
+      stack.emplace(i);
+    }
+    while (!stack.isEmpty()) {
+      keep(stack.pop());
+    }
+  });
+  print_benchmark_row("StackArray<int> (reserved)", ns, 2LL * n);
+
+  ns = best_of_ns(Repetitions, [&] {
+    std::vector<int> stack;
+    for (int i = 0; i < n; i++) {
+      stack.push_back(i);
+    }
+    while (!stack.empty()) {
+      keep(stack.back());
+      stack.pop_back();
+    }
+  });
+  print_benchmark_row("std::vector<int>", ns, 2LL * n);
+
+  const int m = n / 8;
+  ns = best_of_ns(Repetitions, [&] {
+    StackArray<std::string> stack;
+    for (int i = 0; i < m; i++) {
+      stack.emplace(24, 'x');
+    }
+    while (!stack.isEmpty()) {
+      keep(stack.pop().size());
+    }
+  });
+  print_benchmark_row("StackArray<std::string>", ns, 2LL * m);
+
+  ns = best_of_ns(Repetitions, [&] {
+    std::vector<std::string> stack;
+    for (int i = 0; i < m; i++) {
+      stack.emplace_back(24, 'x');
+    }
+    while (!stack.empty()) {
+      keep(stack.back().size());
+      stack.pop_back();
+    }
+  });
+  print_benchmark_row("std::vector<std::string>", ns, 2LL * m);
+  std::cout << std::endl;
+}
+
+// Many short lived stacks, the per-request pattern: construct, push a few
+// elements, drain, destroy. StackArray allocates in its constructor whatever
+// the stack ends up holding; SmallStack only does once it outgrows N.
+template <typename Stack>
+double construct_push_pop_ns(int objects, int pushes) {
+  return best_of_ns(Repetitions, [&] {
+    for (int o = 0; o < objects; o++) {
+      Stack stack;
+      for (int i = 0; i < pushes; i++) {
+        stack.push(o + i);
+      }
+      while (!stack.isEmpty()) {
+        keep(stack.pop());
+      }
+    }
+  });
+}
+
+void bench_small_stack() {
+  const int objects = 1 << 18;
+  print_benchmark_header("SmallStack vs StackArray, construct + push/pop (" +
+                         std::to_string(objects) + " stacks)");
+  for (int pushes : {4, 12, 40}) {
+    std::string suffix = ", " + std::to_string(pushes) + " pushes";
+    print_benchmark_row("StackArray<int>" + suffix,
+                        construct_push_pop_ns<StackArray<int>>(objects, pushes),
+                        objects);
+    print_benchmark_row(
+        "SmallStack<int, 16>" + suffix,
+        construct_push_pop_ns<SmallStack<int, 16>>(objects, pushes), objects);
+  }
+  std::cout << std::endl;
+}
+
+// Streams n ints through each queue in batches, the way the parser hands
+// records to the sorter: a batch goes in, then a batch comes out.
+void bench_queue_array() {
+  const int n = 1 << 20;
+  const int batch = 64;
+  print_benchmark_header("QueueArray vs std::deque / std::queue (n = " +
+                         std::to_string(n) + ", batch = " +
+                         std::to_string(batch) + ")");
+
+  double ns = best_of_ns(Repetitions, [&] {
+    QueueArray<int> queue;
+    for (int i = 0; i < n; i += batch) {
+      for (int j = 0; j < batch; j++) {
+        queue.enqueue(i + j);
+      }
+      for (int j = 0; j < batch; j++) {
+        keep(queue.dequeue());
+      }
+    }
+  });
+  print_benchmark_row("QueueArray<int>", ns, 2LL * n);
+
+  std::vector<int> in(batch);
+  std::vector<int> out(batch);
+  ns = best_of_ns(Repetitions, [&] {
+    QueueArray<int> queue;
+    for (int i = 0; i < n; i += batch) {
+      for (int j = 0; j < batch; j++) {
+        in[j] = i + j;
+      }
+      queue.enqueue_n(in.data(), batch);
+      keep(queue.dequeue_n(out.data(), batch));
+      keep(out[batch - 1]);
+    }
+  });
+  print_benchmark_row("QueueArray<int> enqueue_n/dequeue_n", ns, 2LL * n);
+
+  ns = best_of_ns(Repetitions, [&] {
+    std::deque<int> queue;
+    for (int i = 0; i < n; i += batch) {
+      for (int j = 0; j < batch; j++) {
+        queue.push_back(i + j);
+      }
+      for (int j = 0; j < batch; j++) {
+        keep(queue.front());
+        queue.pop_front();
+      }
+    }
+  });
+  print_benchmark_row("std::deque<int>", ns, 2LL * n);
+
+  ns = best_of_ns(Repetitions, [&] {
+    std::queue<int> queue;
+    for (int i = 0; i < n; i += batch) {
+      for (int j = 0; j < batch; j++) {
+        queue.push(i + j);
+      }
+      for (int j = 0; j < batch; j++) {
+        keep(queue.front());
+        queue.pop();
+      }
+    }
+  });
+  print_benchmark_row("std::queue<int>", ns, 2LL * n);
+  std::cout << std::endl;
+}
+
+// Backs off to the scheduler after a short spin so the two benchmark threads
+// still make progress when they share a core.
+inline void spin_wait(int &spins) {
+  if (++spins > 64) {
+    std::this_thread::yield();
+    spins = 0;
+  }
+}
+
+// Producer thread pushes n ints, the calling thread consumes them.
+template <typename Push, typename Pop>
+void two_thread_transfer(int n, Push push, Pop pop) {
+  std::thread producer([&] {
+    int spins = 0;
+    for (int i = 0; i < n;) {
+      int pushed = push(i);
+      if (pushed == 0) {
+        spin_wait(spins);
+      }
+      i += pushed;
+    }
+  });
+  int spins = 0;
+  for (int received = 0; received < n;) {
+    int popped = pop();
+    if (popped == 0) {
+      spin_wait(spins);
+    }
+    received += popped;
+  }
+  producer.join();
+}
+
+void bench_queue_spsc() {
+  const int n = 1 << 20;
+  const int batch = 32;
+  print_benchmark_header("QueueSPSC two thread transfer (n = " +
+                         std::to_string(n) + ")");
+
+  double ns = best_of_ns(Repetitions, [&] {
+    QueueSPSC<int> queue(1024);
+    two_thread_transfer(
+        n, [&](int i) { return queue.tryEnqueue(i) ? 1 : 0; },
+        [&] {
+          int value;
+          if (!queue.tryDequeue(value)) {
+            return 0;
+          }
+          keep(value);
+          return 1;
+        });
+  });
+  print_benchmark_row("QueueSPSC<int>", ns, n);
+
+  std::vector<int> in(batch);
+  std::vector<int> out(batch);
+  ns = best_of_ns(Repetitions, [&] {
+    QueueSPSC<int> queue(1024);
+    two_thread_transfer(
+        n,
+        [&](int i) {
+          for (int j = 0; j < batch; j++) {
+            in[j] = i + j;
+          }
+          return queue.enqueue_n(in.data(), std::min(batch, n - i));
+        },
+        [&] {
+          int popped = queue.dequeue_n(out.data(), batch);
+          keep(popped > 0 ? out[0] : 0);
+          return popped;
+        });
+  });
+  print_benchmark_row("QueueSPSC<int> enqueue_n/dequeue_n", ns, n);
+
+  ns = best_of_ns(Repetitions, [&] {
+    std::mutex lock;
+    std::queue<int> queue;
+    two_thread_transfer(
+        n,
+        [&](int i) {
+          std::lock_guard<std::mutex> guard(lock);
+          if (queue.size() >= 1024) {
+            return 0;
+          }
+          queue.push(i);
+          return 1;
+        },
+        [&] {
+          std::lock_guard<std::mutex> guard(lock);
+          if (queue.empty()) {
+            return 0;
+          }
+          keep(queue.front());
+          queue.pop();
+          return 1;
+        });
+  });
+  print_benchmark_row("std::mutex + std::queue<int>", ns, n);
+
+  // Ping-pong: one message in flight, so every op is a full cross-thread
+  // handoff. ns/op is the round trip latency.
+  const int round_trips = 1 << 14;
+  ns = best_of_ns(Repetitions, [&] {
+    QueueSPSC<int> ping(16);
+    QueueSPSC<int> pong(16);
+    std::thread echo([&] {
+      int spins = 0;
+      for (int i = 0; i < round_trips; i++) {
+        int value;
+        while (!ping.tryDequeue(value)) {
+          spin_wait(spins);
+        }
+        while (!pong.tryEnqueue(value)) {
+          spin_wait(spins);
+        }
+      }
+    });
+    int spins = 0;
+    for (int i = 0; i < round_trips; i++) {
+      int value;
+      while (!ping.tryEnqueue(i)) {
+        spin_wait(spins);
+      }
+      while (!pong.tryDequeue(value)) {
+        spin_wait(spins);
+      }
+      keep(value);
+    }
+    echo.join();
+  });
+  print_benchmark_row("QueueSPSC<int> ping-pong round trip", ns, round_trips);
+  std::cout << std::endl;
+}
+
+// Every thread alternates enqueue and dequeue on one shared queue, so the
+// same code runs with 1 to 64 threads and the queue never fills up.
+template <typename Enqueue, typename Dequeue>
+void shared_queue_round_trips(int threads, int operations, Enqueue enqueue,
+                              Dequeue dequeue) {
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      for (int i = t; i < operations; i += threads) {
+        enqueue(i);
+        keep(dequeue());
+      }
+    });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+void bench_queue_mpmc() {
+  const int n = 1 << 18;
+  print_benchmark_header("QueueMPMC contention vs std::mutex + std::queue "
+                         "(n = " +
+                         std::to_string(n) + " round trips)");
+  for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+    double ns = best_of_ns(Repetitions, [&] {
+      QueueMPMC<int> queue(1024);
+      shared_queue_round_trips(
+          threads, n, [&](int i) { queue.enqueue(i); },
+          [&] { return queue.dequeue(); });
+    });
+    print_benchmark_row("QueueMPMC<int>, " + std::to_string(threads) +
+                            " threads",
+                        ns, 2LL * n);
+
+    ns = best_of_ns(Repetitions, [&] {
+      std::mutex lock;
+      std::queue<int> queue;
+      shared_queue_round_trips(
+          threads, n,
+          [&](int i) {
+            std::lock_guard<std::mutex> guard(lock);
+            queue.push(i);
+          },
+          [&] {
+            std::lock_guard<std::mutex> guard(lock);
+            int value = queue.front();
+            queue.pop();
+            return value;
+          });
+    });
+    print_benchmark_row("mutex std::queue<int>, " +
+                            std::to_string(threads) + " threads",
+                        ns, 2LL * n);
+  }
+  std::cout << std::endl;
+}
+
+// Stress: every thread pushes and pops in a tight loop, with a few pushes
+// between pops so the stack is never trivially empty. The sums of pushed and
+// popped (plus leftover) values must match or the row reports a failure.
+void bench_stack_lock_free() {
+  const int n = 1 << 18;
+  print_benchmark_header("StackLockFree push/pop stress vs std::mutex + "
+                         "StackLinkedList (n = " +
+                         std::to_string(n) + ")");
+  for (int threads : {1, 2, 4, 8, 16}) {
+    std::atomic<long long> popped_sum{0};
+    bool balanced = true;
+    double ns = best_of_ns(Repetitions, [&] {
+      StackLockFree<int> stack;
+      popped_sum = 0;
+      std::vector<std::thread> workers;
+      for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+          long long sum = 0;
+          int value;
+          for (int i = t; i < n; i += threads) {
+            stack.push(i);
+            if (i % 4 != 0 && stack.tryPop(value)) {
+              sum += value;
+            }
+          }
+          popped_sum += sum;
+        });
+      }
+      for (std::thread &worker : workers) {
+        worker.join();
+      }
+      int value;
+      long long leftover = 0;
+      while (stack.tryPop(value)) {
+        leftover += value;
+      }
+      balanced &= popped_sum + leftover == (long long)n * (n - 1) / 2;
+    });
+    print_benchmark_row("StackLockFree<int>, " + std::to_string(threads) +
+                            " threads" + (balanced ? "" : " FAILED"),
+                        ns, 2LL * n);
+
+    ns = best_of_ns(Repetitions, [&] {
+      std::mutex lock;
+      StackLinkedList<int> stack;
+      std::vector<std::thread> workers;
+      for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+          for (int i = t; i < n; i += threads) {
+            std::lock_guard<std::mutex> guard(lock);
+            stack.push(i);
+            if (i % 4 != 0) {
+              keep(stack.pop());
+            }
+          }
+        });
+      }
+      for (std::thread &worker : workers) {
+        worker.join();
+      }
+    });
+    print_benchmark_row("mutex StackLinkedList<int>, " +
+                            std::to_string(threads) + " threads",
+                        ns, 2LL * n);
+  }
+  std::cout << std::endl;
+}
+
+// Fills a linked container with n elements, drains it, and reports how much
+// memory the full container held: what it reports via bytesReserved() (pool
+// slabs, chunks), or else the heap growth (glibc only).
+template <typename Container, typename Add, typename Remove>
+void bench_linked_container(const std::string &variant, int n, Add add,
+                            Remove remove, std::vector<std::string> &footprint) {
+  long long bytes = -1;
+  double ns = best_of_ns(Repetitions, [&] {
+    long long before = heap_bytes_in_use();
+    Container container;
+    for (int i = 0; i < n; i++) {
+      add(container, i);
+    }
+    long long after = heap_bytes_in_use();
+    if (container.bytesReserved() > 0) {
+      bytes = (long long)container.bytesReserved();
+    } else if (before >= 0) {
+      bytes = after - before;
+    }
+    while (!container.isEmpty()) {
+      keep(remove(container));
+    }
+  });
+  print_benchmark_row(variant, ns, 2LL * n);
+  footprint.push_back(variant + ": " +
+                      (bytes < 0 ? std::string("n/a")
+                                 : std::to_string(bytes) + " bytes, " +
+                                       std::to_string(double(bytes) / n) +
+                                       " bytes/element"));
+}
+
+void bench_pool_allocator() {
+  const int n = 1 << 20;
+  print_benchmark_header("Linked containers: new/delete vs pool allocators "
+                         "(n = " +
+                         std::to_string(n) + ")");
+  std::vector<std::string> footprint;
+  auto push = [](auto &stack, int i) { stack.push(i); };
+  auto pop = [](auto &stack) { return stack.pop(); };
+  auto enqueue = [](auto &queue, int i) { queue.enqueue(i); };
+  auto dequeue = [](auto &queue) { return queue.dequeue(); };
+
+  bench_linked_container<StackLinkedList<int>>("StackLinkedList new/delete", n,
+                                               push, pop, footprint);
+  bench_linked_container<StackLinkedList<int, PoolAllocator>>(
+      "StackLinkedList PoolAllocator", n, push, pop, footprint);
+  bench_linked_container<StackLinkedList<int, SharedPoolAllocator>>(
+      "StackLinkedList SharedPoolAllocator", n, push, pop, footprint);
+  bench_linked_container<QueueLinkedList<int>>("QueueLinkedList new/delete", n,
+                                               enqueue, dequeue, footprint);
+  bench_linked_container<QueueLinkedList<int, PoolAllocator>>(
+      "QueueLinkedList PoolAllocator", n, enqueue, dequeue, footprint);
+  bench_linked_container<QueueLinkedList<int, SharedPoolAllocator>>(
+      "QueueLinkedList SharedPoolAllocator", n, enqueue, dequeue, footprint);
+
+  std::cout << "Memory footprint when full:" << std::endl;
+  for (const std::string &line : footprint) {
+    std::cout << "  " << line << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+// Same fill-then-drain and steady state patterns for the node based queue,
+// the chunked queue that replaces it, and the ring buffer.
+void bench_queue_chunked() {
+  const int n = 1 << 20;
+  print_benchmark_header("QueueChunked vs QueueLinkedList / QueueArray (n = " +
+                         std::to_string(n) + ")");
+  std::vector<std::string> footprint;
+  auto enqueue = [](auto &queue, int i) { queue.enqueue(i); };
+  auto dequeue = [](auto &queue) { return queue.dequeue(); };
+  bench_linked_container<QueueLinkedList<int>>("QueueLinkedList fill/drain", n,
+                                               enqueue, dequeue, footprint);
+  bench_linked_container<QueueChunked<int>>("QueueChunked fill/drain", n,
+                                            enqueue, dequeue, footprint);
+
+  const int in_flight = 1000;
+  auto steady = [&](auto &queue) {
+    for (int i = 0; i < in_flight; i++) {
+      queue.enqueue(i);
+    }
+    for (int i = 0; i < n; i++) {
+      queue.enqueue(i);
+      keep(queue.dequeue());
+    }
+  };
+  double ns = best_of_ns(Repetitions, [&] {
+    QueueLinkedList<int> queue;
+    steady(queue);
+  });
+  print_benchmark_row("QueueLinkedList steady state", ns, 2LL * n);
+  ns = best_of_ns(Repetitions, [&] {
+    QueueChunked<int> queue;
+    steady(queue);
+  });
+  print_benchmark_row("QueueChunked steady state", ns, 2LL * n);
+  ns = best_of_ns(Repetitions, [&] {
+    QueueArray<int> queue;
+    steady(queue);
+  });
+  print_benchmark_row("QueueArray steady state", ns, 2LL * n);
+
+  std::cout << "Memory footprint when full:" << std::endl;
+  for (const std::string &line : footprint) {
+    std::cout << "  " << line << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+long long now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+// One producer stamps every message with the time it was pushed; the
+// consumer records now - stamp as it takes it. handoff only has the messages
+// that were pushed into an empty queue, nothing ahead of them, so it is the
+// time to get one element across (including the wakeup when the consumer
+// had parked). queued has every message, so it adds the time spent behind a
+// backlog when the producer runs ahead.
+struct HandoffLatencies {
+  std::vector<double> handoff;
+  std::vector<double> queued;
+};
+
+template <typename Consume>
+HandoffLatencies handoff_latencies(QueueBlocking<long long> &queue,
+                                   int messages, int gap_us, Consume consume) {
+  HandoffLatencies latencies;
+  latencies.handoff.reserve(messages);
+  latencies.queued.reserve(messages);
+  std::thread producer([&] {
+    for (int i = 0; i < messages; i++) {
+      if (gap_us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(gap_us));
+      }
+      // Only this thread pushes, so a queue seen empty stays empty until
+      // the push. Negative stamps mark messages that joined a backlog.
+      bool empty = queue.isEmpty();
+      long long stamp = now_ns();
+      queue.push(empty ? stamp : -stamp);
+    }
+  });
+  while (int(latencies.queued.size()) < messages) {
+    consume([&](long long stamp) {
+      long long now = now_ns();
+      if (stamp > 0) {
+        latencies.handoff.push_back(now - stamp);
+      }
+      latencies.queued.push_back(now - std::llabs(stamp));
+    });
+  }
+  producer.join();
+  return latencies;
+}
+
+void print_latency_rows(const std::string &variant,
+                        HandoffLatencies &latencies, bool backlog) {
+  print_latency_row(variant + " handoff", latencies.handoff);
+  if (backlog) {
+    print_latency_row(variant + " queued", latencies.queued);
+  }
+}
+
+void bench_queue_blocking() {
+  print_latency_header("QueueBlocking push to pop latency");
+  const int light_messages = 2000;
+  const int light_gap_us = 50;
+  const int heavy_messages = 1 << 18;
+  const int batch = 64;
+  std::vector<long long> out(batch);
+
+  QueueBlocking<long long> queue;
+  HandoffLatencies latencies = handoff_latencies(
+      queue, light_messages, light_gap_us,
+      [&](auto record) { record(queue.pop_wait()); });
+  print_latency_rows("light, pop_wait", latencies, false);
+
+  latencies = handoff_latencies(queue, light_messages, light_gap_us,
+                                [&](auto record) {
+                                  long long stamp;
+                                  int spins = 0;
+                                  while (!queue.tryPop(stamp)) {
+                                    spin_wait(spins);
+                                  }
+                                  record(stamp);
+                                });
+  print_latency_rows("light, busy-polling tryPop", latencies, false);
+
+  latencies = handoff_latencies(queue, heavy_messages, 0, [&](auto record) {
+    int count = queue.pop_batch_wait(out.data(), batch,
+                                     std::chrono::milliseconds(1));
+    for (int i = 0; i < count; i++) {
+      record(out[i]);
+    }
+  });
+  print_latency_rows("heavy, pop_batch_wait(64)", latencies, true);
+
+  latencies = handoff_latencies(queue, heavy_messages, 0,
+                                [&](auto record) { record(queue.pop_wait()); });
+  print_latency_rows("heavy, pop_wait", latencies, true);
+  std::cout << std::endl;
+
+  print_benchmark_header("QueueBlocking transfer (n = " +
+                         std::to_string(heavy_messages) + ")");
+  // Throughput of the heavy transfer, for comparison with the other queues.
+  double ns = best_of_ns(Repetitions, [&] {
+    QueueBlocking<long long> transfer;
+    std::thread producer([&] {
+      for (int i = 0; i < heavy_messages; i++) {
+        transfer.push(i);
+      }
+    });
+    for (int received = 0; received < heavy_messages;) {
+      int count = transfer.pop_batch_wait(out.data(), batch,
+                                          std::chrono::milliseconds(1));
+      keep(count > 0 ? out[0] : 0);
+      received += count;
+    }
+    producer.join();
+  });
+  print_benchmark_row("transfer, pop_batch_wait(64)", ns, heavy_messages);
+  std::cout << std::endl;
+}
+
+// Fork-join mergesort on a work-stealing pool. A task either sorts its range
+// with a2's MergesortBook or forks: the right half is pushed on the worker's
+// deque for thieves and the left half runs inline. Joins are continuations:
+// whichever child finishes last merges the parent's halves with MergeRuns and
+// carries on upwards, so no thread ever blocks waiting for a child.
+struct SortTask {
+  int start;
+  int mid;
+  int end;
+  SortTask *parent;
+  std::atomic<int> pending{2};
+};
+
+class ForkJoinMergesort {
+private:
+  static const int Cutoff = 2048;
+  int *elements;
+  int *scratch;
+  std::vector<std::unique_ptr<DequeWorkStealing<SortTask *>>> deques;
+  std::atomic<bool> done{false};
+
+  void complete(SortTask *task) {
+    while (true) {
+      SortTask *parent = task->parent;
+      delete task;
+      if (parent == nullptr) {
+        done.store(true, std::memory_order_release);
+        return;
+      }
+      if (parent->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return; // The sibling is still running and will do the merge.
+      }
+      MergeRuns(elements, scratch + parent->start, parent->start, parent->mid,
+                parent->end);
+      task = parent;
+    }
+  }
+
+  void run(SortTask *task, int worker) {
+    while (task->end - task->start > Cutoff) {
+      task->mid = task->start + (task->end - task->start) / 2;
+      SortTask *right = new SortTask{task->mid, 0, task->end, task};
+      deques[worker]->push(right);
+      task = new SortTask{task->start, 0, task->mid, task};
+    }
+    MergesortBook(elements + task->start, task->end - task->start);
+    complete(task);
+  }
+
+  void work(int worker) {
+    int workers = int(deques.size());
+    int spins = 0;
+    while (!done.load(std::memory_order_acquire)) {
+      SortTask *task = nullptr;
+      bool found = deques[worker]->pop(task);
+      for (int i = 1; !found && i < workers; i++) {
+        found = deques[(worker + i) % workers]->steal(task);
+      }
+      if (found) {
+        run(task, worker);
+        spins = 0;
+      } else {
+        spin_wait(spins);
+      }
+    }
+  }
+
+public:
+  ForkJoinMergesort(int *elements, int nrOfElements, int workers)
+      : elements(elements), scratch(new int[nrOfElements]) {
+    for (int i = 0; i < workers; i++) {
+      deques.emplace_back(new DequeWorkStealing<SortTask *>());
+    }
+    deques[0]->push(new SortTask{0, 0, nrOfElements, nullptr});
+    std::vector<std::thread> threads;
+    for (int i = 1; i < workers; i++) {
+      threads.emplace_back(&ForkJoinMergesort::work, this, i);
+    }
+    work(0);
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+  }
+  ~ForkJoinMergesort() { delete[] scratch; }
+};
+
+void bench_work_stealing() {
+  const int n = 1 << 20;
+  print_benchmark_header("Fork-join Mergesort on DequeWorkStealing (n = " +
+                         std::to_string(n) + ")");
+  std::vector<int> input(n);
+  std::mt19937 generator(12345);
+  for (int &value : input) {
+    value = int(generator());
+  }
+  std::vector<int> expected = input;
+  std::sort(expected.begin(), expected.end());
+
+  std::vector<int> elements;
+  double ns = best_of_ns(Repetitions, [&] {
+    elements = input;
+    MergesortBook(elements.data(), n);
+  });
+  print_benchmark_row(std::string("MergesortBook serial") +
+                          (elements == expected ? "" : " FAILED"),
+                      ns, n);
+
+  for (int workers : {1, 2, 4, 8}) {
+    ns = best_of_ns(Repetitions, [&] {
+      elements = input;
+      ForkJoinMergesort(elements.data(), n, workers);
+    });
+    print_benchmark_row("work stealing, " + std::to_string(workers) +
+                            " workers" + (elements == expected ? "" : " FAILED"),
+                        ns, n);
+  }
+  std::cout << std::endl;
+}
+
+struct Benchmark {
+  const char *name;
+  void (*run)();
+};
+
+// Runs every benchmark, or only those named on the command line.
+int main(int argc, char *argv[]) {
+  std::vector<Benchmark> benchmarks = {
+      {"stack", bench_stack_array},
+      {"smallstack", bench_small_stack},
+      {"queue", bench_queue_array},
+      {"spsc", bench_queue_spsc},
+      {"mpmc", bench_queue_mpmc},
+      {"blocking", bench_queue_blocking},
+      {"lockfree", bench_stack_lock_free},
+      {"pool", bench_pool_allocator},
+      {"chunked", bench_queue_chunked},
+      {"workstealing", bench_work_stealing},
+  };
+  for (const Benchmark &benchmark : benchmarks) {
+    bool selected = argc <= 1;
+    for (int i = 1; i < argc; i++) {
+      selected |= std::strcmp(argv[i], benchmark.name) == 0;
+    }
+    if (selected) {
+      benchmark.run();
+    }
+  }
+  return 0;
+}